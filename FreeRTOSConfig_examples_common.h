@@ -76,16 +76,39 @@
 #ifndef configSUPPORT_DYNAMIC_ALLOCATION
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
 #endif
+#ifndef configTOTAL_HEAP_SIZE
 #define configTOTAL_HEAP_SIZE                   (128*1024)
+#endif
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
+/* Diagnostics build: run time stats, stack overflow and malloc failed hooks.
+Enabled with -DTHERMAL_DIAGNOSTICS=1, see diagnostics.c for the reporter. */
+#ifndef THERMAL_DIAGNOSTICS
+#define THERMAL_DIAGNOSTICS                     0
+#endif
+
 /* Hook function related definitions. */
+#if THERMAL_DIAGNOSTICS
+#define configCHECK_FOR_STACK_OVERFLOW          2
+#define configUSE_MALLOC_FAILED_HOOK            1
+#else
 #define configCHECK_FOR_STACK_OVERFLOW          0
 #define configUSE_MALLOC_FAILED_HOOK            0
+#endif
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
+#if THERMAL_DIAGNOSTICS
+#define configGENERATE_RUN_TIME_STATS           1
+#define configRUN_TIME_COUNTER_TYPE             uint64_t
+#ifndef __ASSEMBLER__
+extern uint64_t diagnostics_run_time_counter(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        diagnostics_run_time_counter()
+#else
 #define configGENERATE_RUN_TIME_STATS           0
+#endif
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
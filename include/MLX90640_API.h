@@ -41,6 +41,7 @@
 #define MLX90640_COLUMN_SIZE 24
 #define MLX90640_AUX_DATA_START_ADDRESS 0x0700
 #define MLX90640_AUX_NUM 64
+#define MLX90640_FRAME_DATA_NUM 834
 #define MLX90640_STATUS_REG 0x8000
 #define MLX90640_INIT_STATUS_VALUE 0x0030
 #define MLX90640_STAT_FRAME_MASK BIT_MASK(0) 
@@ -57,6 +58,9 @@
 #define MLX90640_CTRL_MEAS_MODE_SHIFT 12
 #define MLX90640_CTRL_MEAS_MODE_MASK BIT_MASK(12)
 
+#define MLX90640_IS_CHESS_MODE(frameData) ((frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) != 0)
+#define MLX90640_PIXEL_PATTERN(pixel, chess) ((chess) ? ((((pixel) >> 5) ^ (pixel)) & 1) : (((pixel) >> 5) & 1))
+
 #define MLX90640_MS_BYTE_SHIFT 8
 #define MLX90640_MS_BYTE_MASK 0xFF00
 #define MLX90640_LS_BYTE_MASK 0x00FF
@@ -107,16 +111,132 @@ typedef struct
         uint16_t brokenPixels[5];
         uint16_t outlierPixels[5];  
     } paramsMLX90640;
+
+    // 每个子页只算一次的帧上下文：PrepareFrame 填写与发射率无关的部分，
+    // PrepareToContext 再填写 emissivity/taTr，CalculateToRange/GetImageContext 共享
+    typedef struct
+    {
+        float vdd;
+        float ta;
+        float ta4;
+        float taTr;
+        float tr;
+        float gain;
+        float emissivity;
+        float irDataCP[2];
+        float ktaScale;
+        float kvScale;
+        float alphaScale;
+        float alphaCorrR[4];
+        uint8_t mode;
+        uint16_t subPage;
+        const float *offsetCompensated;    // 非 NULL 时像素偏移补偿直接取缓存
+    } frameContextMLX90640;
+    
+    // 像素偏移补偿 offset*(1+kta*(ta-25))*(1+kv*(vdd-3.3)) 的缓存，
+    // Ta/Vdd 相对上次刷新的漂移超过量化步长才整表重算。
+    // 命中时补偿的误差约 |offset|*(|kta|*dTa + |kv|*dVdd) 个计数，dTa/dVdd 小于量化步长；
+    // 默认 0.05°C/2mV、偏移几十到一百多计数时 To 误差在 0.005°C 左右，
+    // tools/replay_bench 按 REFERENCE_TO_CACHED_TOLERANCE (0.02°C) 检查
+    typedef struct
+    {
+        float compensated[MLX90640_PIXEL_NUM];
+        float ta;
+        float vdd;
+        float taQuantum;
+        float vddQuantum;
+        uint8_t valid;
+        uint32_t hits;
+        uint32_t misses;
+    } offsetCacheMLX90640;
+    
+    // 静态场景的增量 To：像素原始值相对上次计算的变化不超过噪声底，且该子页的
+    // Ta/Vdd/Tr/发射率/增益/补偿像素都没变时，沿用 result 中上一次的 To 不再重算。
+    // 沿用的 To 对应的 Ta/Vdd/Tr 最多差一个量化步长，噪声底为 0 时结果也不与完整计算逐位相同；
+    // 误差上限见 tools/mlx90640_reference.h 的 REFERENCE_TO_LAZY_*，由 tools/replay_bench 检查
+    typedef struct
+    {
+        int16_t lastRaw[MLX90640_PIXEL_NUM];
+        uint32_t dirty[MLX90640_PIXEL_NUM / 32];    // 每行一个字，置位的像素本子页需要重算
+        float ta[2];
+        float vdd[2];
+        float tr[2];
+        float emissivity[2];
+        int16_t gainRaw[2];
+        int16_t cpRaw[2];
+        uint8_t mode[2];
+        uint8_t valid[2];
+        uint16_t noiseFloor;
+        float taQuantum;
+        float vddQuantum;
+        uint32_t computed;
+        uint32_t skipped;
+        uint32_t refreshes;
+    } lazyToMLX90640;
+    
+    // To 计算时顺带按 [minTemp, maxTemp] 量化成 0~255 调色板索引（与 palette_index 相同），
+    // index/color 非 NULL 的才写；mirror 非 0 时每行左右镜像，省掉单独的着色遍历
+    typedef struct
+    {
+        float minTemp;
+        float maxTemp;
+        uint8_t mirror;
+        uint8_t *index;
+        const uint16_t *lut;
+        uint16_t *color;
+    } toPaletteMLX90640;
+    
+    #define MLX90640_BAD_PIXELS_MAX 32
+    #define MLX90640_BAD_PIXEL_COPY 0
+    #define MLX90640_BAD_PIXEL_MEAN2 1
+    #define MLX90640_BAD_PIXEL_MEDIAN4 2
+    #define MLX90640_BAD_PIXEL_GRADIENT 3
+    
+    typedef struct
+    {
+        uint16_t pixel;
+        uint8_t method;
+        uint16_t neighbors[4];
+    } badPixelFixMLX90640;
+    
+    typedef struct
+    {
+        uint16_t count;
+        badPixelFixMLX90640 fix[MLX90640_BAD_PIXELS_MAX];
+    } badPixelPlanMLX90640;
+    
+    // GetFrameData/GetSubpageData/TriggerMeasurement 的 I2C 传输计数
+    typedef struct
+    {
+        uint32_t frames;
+        uint32_t transactions;
+        uint32_t statusPolls;
+        uint16_t lastTransactions;
+        uint16_t lastStatusPolls;
+    } transferStatsMLX90640;
     
     int MLX90640_DumpEE(uint8_t slaveAddr, uint16_t *eeData);
     int MLX90640_SynchFrame(uint8_t slaveAddr);
     int MLX90640_TriggerMeasurement(uint8_t slaveAddr);
     int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData);
+    int MLX90640_GetSubpageData(uint8_t slaveAddr, uint16_t *frameData);
+    void MLX90640_GetTransferStats(transferStatsMLX90640 *stats);
     int MLX90640_ExtractParameters(uint16_t *eeData, paramsMLX90640 *mlx90640);
     float MLX90640_GetVdd(uint16_t *frameData, const paramsMLX90640 *params);
     float MLX90640_GetTa(uint16_t *frameData, const paramsMLX90640 *params);
     void MLX90640_GetImage(uint16_t *frameData, const paramsMLX90640 *params, float *result);
     void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, float *result);
+    void MLX90640_PrepareFrame(uint16_t *frameData, const paramsMLX90640 *params, frameContextMLX90640 *context);
+    void MLX90640_PrepareToContext(frameContextMLX90640 *context, float emissivity, float tr);
+    void MLX90640_PrepareTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, frameContextMLX90640 *context);
+    void MLX90640_CalculateToRange(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, int firstPixel, int lastPixel, float *result);
+    void MLX90640_CalculateToPaletteRange(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, const toPaletteMLX90640 *palette, int firstPixel, int lastPixel, float *result);
+    void MLX90640_OffsetCacheInit(offsetCacheMLX90640 *cache, float taQuantum, float vddQuantum);
+    void MLX90640_OffsetCacheUpdate(offsetCacheMLX90640 *cache, const paramsMLX90640 *params, frameContextMLX90640 *context);
+    void MLX90640_LazyToInit(lazyToMLX90640 *lazy, uint16_t noiseFloor, float taQuantum, float vddQuantum);
+    void MLX90640_LazyToPrepare(lazyToMLX90640 *lazy, uint16_t *frameData, const frameContextMLX90640 *context);
+    void MLX90640_CalculateToLazyRange(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, const lazyToMLX90640 *lazy, const toPaletteMLX90640 *palette, int firstPixel, int lastPixel, float *result);
+    void MLX90640_GetImageContext(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, float *result);
     int MLX90640_SetResolution(uint8_t slaveAddr, uint8_t resolution);
     int MLX90640_GetCurResolution(uint8_t slaveAddr);
     int MLX90640_SetRefreshRate(uint8_t slaveAddr, uint8_t refreshRate);   
@@ -126,5 +246,10 @@ typedef struct
     int MLX90640_SetInterleavedMode(uint8_t slaveAddr);
     int MLX90640_SetChessMode(uint8_t slaveAddr);
     void MLX90640_BadPixelsCorrection(uint16_t *pixels, float *to, int mode, paramsMLX90640 *params);
+    void MLX90640_BadPixelPlanInit(badPixelPlanMLX90640 *plan);
+    int MLX90640_BadPixelPlanAdd(badPixelPlanMLX90640 *plan, uint16_t pixel, int mode, paramsMLX90640 *params);
+    int MLX90640_BadPixelPlanAddList(badPixelPlanMLX90640 *plan, uint16_t *pixels, int mode, paramsMLX90640 *params);
+    void MLX90640_BadPixelPlanApply(const badPixelPlanMLX90640 *plan, float *to);
+    void MLX90640_BadPixelPlanPalette(const badPixelPlanMLX90640 *plan, const toPaletteMLX90640 *palette, const float *to);
     
 #endif
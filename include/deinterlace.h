@@ -0,0 +1,22 @@
+#ifndef _DEINTERLACE_H_
+#define _DEINTERLACE_H_
+
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+#include "include/temp_centi.h"
+
+// 子页去隔行：本子页未更新的像素，若周围新像素帧间变化绝对值的均值超过阈值，
+// 则用新像素的空间均值代替旧值，消除运动时的棋盘格撕裂
+#define DEINTERLACE_MOTION_LIMIT 0.5f
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t replaced;
+} deinterlace_stats_t;
+
+void deinterlace_init(float motion_limit);
+void deinterlace_apply(uint16_t *frameData, const thermal_temp_t *to, thermal_temp_t *result);
+void deinterlace_get_stats(deinterlace_stats_t *stats);
+
+#endif
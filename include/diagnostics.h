@@ -0,0 +1,19 @@
+#ifndef _DIAGNOSTICS_H_
+#define _DIAGNOSTICS_H_
+
+#include <stdint.h>
+#include "include/spsc_ring.h"
+
+#define DIAGNOSTICS_REPORT_PERIOD_MS 5000
+#define DIAGNOSTICS_MAX_TASKS 12
+
+// 诊断模式：打印各任务 CPU 占用、栈余量和 heap4 历史最小剩余
+// 仅在 THERMAL_DIAGNOSTICS=1 时有效，否则为空操作
+void diagnostics_start(void);
+void diagnostics_report(void);
+void diagnostics_watch_ring(const spsc_ring_t *ring);
+uint64_t diagnostics_run_time_counter(void);
+// 处理任务定期单核重算一次 To，与同一帧的双核耗时一起在下次报告中打印
+void diagnostics_note_to_bench(uint32_t single_us, uint32_t dual_us);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef _DUAL_CORE_H_
+#define _DUAL_CORE_H_
+
+#include "FreeRTOS.h"
+
+// 双核 fork/join：[0, split) 在调用者所在核计算，[split, count) 交给另一个核上的工作任务
+// configNUMBER_OF_CORES == 1 时全部在调用者中执行
+typedef void (*dual_core_work_t)(void *arg, int first, int last);
+
+#define DUAL_CORE_WORKER_PRIORITY 3
+#define DUAL_CORE_WORKER_STACK_WORDS 512
+
+void dual_core_init(int worker_core);
+void dual_core_run(dual_core_work_t work, void *arg, int count);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef _FRAME_CODEC_H_
+#define _FRAME_CODEC_H_
+
+#include <stdint.h>
+
+// 原始帧字的无损压缩：预测残差 zigzag 后按 32 字一块编码
+// 不依赖 pico SDK，主机端工具直接编译本文件
+#define FRAME_CODEC_BLOCK 32
+
+typedef enum
+{
+    FRAME_CODEC_RAW = 0,            // 不压缩，小端 16 位
+    FRAME_CODEC_SPATIAL = 1,        // 以前一个字为预测，位打包，可单独解码
+    FRAME_CODEC_TEMPORAL = 2,       // 以参考帧同位置的字为预测，位打包
+    FRAME_CODEC_RICE_SPATIAL = 3,   // 像素区用 MED 预测，块内 Rice/位打包择优
+    FRAME_CODEC_RICE_TEMPORAL = 4,  // 参考帧 + 同子页左邻的帧间变化作预测
+    FRAME_CODEC_MODE_NUM
+} frame_codec_mode_t;
+
+// 最坏情况：每块 1 字节头 + 16 位原值，Rice 块不会比位打包更长
+#define FRAME_CODEC_MAX_BYTES(count) ((((count) + FRAME_CODEC_BLOCK - 1) / FRAME_CODEC_BLOCK) + (count) * 2)
+
+int frame_codec_encode(frame_codec_mode_t mode, const uint16_t *words, const uint16_t *reference, int count, uint8_t *out);
+int frame_codec_decode(frame_codec_mode_t mode, const uint8_t *in, int size, const uint16_t *reference, int count, uint16_t *words);
+
+#endif
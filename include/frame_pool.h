@@ -0,0 +1,34 @@
+#ifndef _FRAME_POOL_H_
+#define _FRAME_POOL_H_
+
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+
+// 一帧数据：原始子页及其帧上下文，采集、计算、录制、发送各阶段通过引用计数共享同一帧
+// 温度场跨帧累积（每个子页只刷新一半像素），不随帧走，由处理任务在 arena 里原地更新
+typedef struct
+{
+    uint16_t frameData[MLX90640_FRAME_DATA_NUM];
+    frameContextMLX90640 context;       // 处理任务每个子页算一次，后续各级共用
+    uint32_t sequence;
+    uint32_t time_ms;       // 读完本子页时上电后的毫秒数
+    uint32_t acquire_us;
+    uint8_t refs;
+} thermal_frame_t;
+
+typedef struct
+{
+    uint32_t acquired;
+    uint32_t released;
+    uint32_t exhausted;
+    uint8_t in_use;
+    uint8_t in_use_max;
+} frame_pool_stats_t;
+
+void frame_pool_init(thermal_frame_t *frames, int count);
+thermal_frame_t *frame_pool_acquire(void);
+void frame_pool_retain(thermal_frame_t *frame);
+void frame_pool_release(thermal_frame_t *frame);
+void frame_pool_get_stats(frame_pool_stats_t *stats);
+
+#endif
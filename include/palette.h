@@ -0,0 +1,13 @@
+#ifndef _PALETTE_H_
+#define _PALETTE_H_
+
+#include <stdint.h>
+
+// 温度场着色：按显示范围归一化到 0~255，输出按列左右镜像，与 LCD 安装方向一致
+void palette_colorize(const float *temps, float min_temp, float max_temp, const uint16_t *lut, uint16_t *color);
+void palette_index(const float *temps, float min_temp, float max_temp, uint8_t *index);
+// 紧凑温度场（0.01°C）版本，范围也以 0.01°C 给出，全程整数运算
+void palette_colorize_centi(const int16_t *temps, int16_t min_temp, int16_t max_temp, const uint16_t *lut, uint16_t *color);
+void palette_index_centi(const int16_t *temps, int16_t min_temp, int16_t max_temp, uint8_t *index);
+
+#endif
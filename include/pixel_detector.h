@@ -0,0 +1,41 @@
+#ifndef _PIXEL_DETECTOR_H_
+#define _PIXEL_DETECTOR_H_
+
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+#include "include/temp_centi.h"
+
+// 运行时坏点检测：逐像素跟踪原始值是否卡死和时间方差，每像素每帧 O(1)
+// 只看温度与邻点的偏差会把静止场景里的真实热点（元件、灯）当成坏点，所以不单独作为判据
+#define PIXEL_STUCK_FRAMES 16         // 子页更新时原始值连续不变的次数
+#define PIXEL_SUSPECT_FRAMES 128      // 连续可疑多少次后判为坏点
+#define PIXEL_NOISE_LIMIT 40000       // 时间方差上限，(0.01°C)^2
+#define PIXEL_NOISE_RATIO 4           // 方差还须超过四邻平均方差的倍数，排除整体运动的场景
+#define PIXEL_DETECTOR_MAX 16         // 最多记录的运行时坏点数
+#define PIXEL_DETECTOR_RETRY_FRAMES 64    // flash 写入失败后隔多少帧重试
+
+// 检测结果保存在 flash 最后一个扇区
+#define PIXEL_DETECTOR_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define PIXEL_DETECTOR_MAGIC 0x50445431
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint32_t flash_writes;
+    uint32_t flash_failures;    // flash_safe_execute 未返回 PICO_OK 的次数，记录保持待写
+    uint16_t found;
+    uint8_t dirty;              // 修正表已变，flash 中的记录尚未更新
+} pixel_detector_stats_t;
+
+int pixel_detector_init(badPixelPlanMLX90640 *plan, paramsMLX90640 *params, int mode);
+int pixel_detector_update(uint16_t *frameData, const thermal_temp_t *to);
+void pixel_detector_get_stats(pixel_detector_stats_t *stats);
+// 以下函数须与 pixel_detector_update 在同一任务中调用；前两个重建修正表，flash 记录只标记待写
+int pixel_detector_forget(uint16_t pixel);
+void pixel_detector_reset(void);
+// 在帧边界调用：有待写记录时擦写 flash（两个核和 XIP 都会暂停），失败则隔几帧重试
+int pixel_detector_flush(void);
+
+#endif
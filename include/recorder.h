@@ -0,0 +1,45 @@
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+#include <stdint.h>
+#include "include/frame_pool.h"
+#include "include/pixel_detector.h"
+#include "include/recorder_format.h"
+
+// 原始帧录制：采集任务把帧指针放入队列（不拷贝 frameData），录制任务压缩后按整扇区写入 flash
+// 录制区在上电时（调度器启动前）一次擦好，运行中只做整扇区编程
+// 仅在 THERMAL_RECORDER=1 时有效，否则为空操作
+#ifndef RECORDER_FLASH_SIZE
+#define RECORDER_FLASH_SIZE (1024 * 1024)
+#endif
+// 紧贴坏点记录扇区之下；上电时与 __flash_binary_end 比较，与固件重叠则不录制
+#define RECORDER_FLASH_OFFSET (PIXEL_DETECTOR_FLASH_OFFSET - RECORDER_FLASH_SIZE)
+#define RECORDER_SECTOR_NUM (RECORDER_FLASH_SIZE / RECORDER_SECTOR_BYTES)
+#define RECORDER_QUEUE_LENGTH 2
+// 帧池为录制多备 队列 + 编码中 1 帧 + 参考帧 1 帧
+#if THERMAL_RECORDER
+#define RECORDER_POOL_FRAMES (RECORDER_QUEUE_LENGTH + 2)
+#else
+#define RECORDER_POOL_FRAMES 0
+#endif
+// 剩余空间不足时上电清空整个录制区，重新开始记录
+#define RECORDER_MIN_FREE_SECTORS 16
+
+typedef struct
+{
+    uint32_t session;
+    uint32_t frames;
+    uint32_t dropped;       // 队列满或录制区已满时丢弃的帧
+    uint32_t sectors;       // 已写入的扇区，含之前会话
+    uint32_t raw_bytes;
+    uint32_t encoded_bytes;
+    uint32_t write_us_max;
+    uint8_t full;
+} recorder_stats_t;
+
+int recorder_init(const uint16_t *eeData, uint8_t refresh_rate, uint8_t resolution, uint8_t chess_mode);
+void recorder_start(void);
+void recorder_submit(thermal_frame_t *frame);
+void recorder_get_stats(recorder_stats_t *stats);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _RECORDER_FORMAT_H_
+#define _RECORDER_FORMAT_H_
+
+#include <stdint.h>
+
+// 录制日志格式，固件和主机端解码工具共用
+// 日志按 4KB 扇区追加，每个扇区以扇区头开始，记录不跨扇区，剩余空间保持 0xFF
+// 扇区内第一帧用空间预测编码，单个扇区可独立解码
+#define RECORDER_SECTOR_BYTES 4096
+#define RECORDER_SECTOR_MAGIC 0x31535254    // "TRS1"
+
+#define RECORDER_RECORD_SESSION 0x01    // 会话开始：EEPROM 转储和采集设置
+#define RECORDER_RECORD_FRAME 0x02      // 一个原始子页 frameData[834]
+
+#define RECORDER_EEPROM_WORDS 832
+#define RECORDER_FRAME_WORDS 834
+
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t session;
+    uint32_t index;         // 会话内扇区序号
+    uint16_t used;          // 含扇区头的已用字节数
+    uint16_t records;
+} recorder_sector_header_t;
+
+typedef struct __attribute__((packed))
+{
+    uint8_t type;
+    uint8_t encoding;       // frame_codec_mode_t
+    uint16_t length;        // 记录头之后的字节数
+} recorder_record_header_t;
+
+typedef struct __attribute__((packed))
+{
+    uint8_t refresh_rate;
+    uint8_t resolution;
+    uint8_t chess_mode;
+    uint8_t reserved;
+    uint16_t eeData[RECORDER_EEPROM_WORDS];
+} recorder_session_t;
+
+// 帧记录：本结构之后是编码后的 frameData
+typedef struct __attribute__((packed))
+{
+    uint32_t sequence;
+    uint32_t time_ms;       // 上电后的毫秒数
+    uint32_t acquire_us;
+} recorder_frame_t;
+
+#endif
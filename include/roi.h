@@ -0,0 +1,38 @@
+#ifndef _ROI_H_
+#define _ROI_H_
+
+#include <stdint.h>
+#include "include/temp_centi.h"
+
+// 感兴趣区域统计：矩形/点/线/多边形先展开成像素掩码，每帧只遍历落在某个 ROI 内的像素，
+// 一次读取同时累加所有覆盖该像素的 ROI。坐标为传感器坐标，x 为列 0~31，y 为行 0~23
+#define ROI_MAX 8
+#define ROI_POLYGON_MAX 8
+
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+} roi_point_t;
+
+// 温度均为 0.01°C；像素号为传感器行优先顺序，无有效像素时 count 为 0
+typedef struct
+{
+    uint16_t count;
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    uint16_t stddev;
+    uint16_t min_pixel;
+    uint16_t max_pixel;
+} roi_stats_t;
+
+void roi_init(void);
+int roi_add_rect(int x0, int y0, int x1, int y1);
+int roi_add_spot(int x, int y, int radius);
+int roi_add_line(int x0, int y0, int x1, int y1);
+int roi_add_polygon(const roi_point_t *points, int count);
+void roi_update(const thermal_temp_t *to);
+int roi_get_stats(roi_stats_t *stats);
+
+#endif
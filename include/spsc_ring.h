@@ -0,0 +1,49 @@
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "include/frame_pool.h"
+
+// 容量必须是 2 的幂
+#define SPSC_RING_CAPACITY 2
+
+typedef enum
+{
+    SPSC_RING_BLOCK = 0,        // 满时生产者等待
+    SPSC_RING_DROP_NEWEST = 1,  // 满时丢弃新帧并归还帧池，生产者从不等待
+} spsc_ring_policy_t;
+
+typedef struct
+{
+    uint32_t pushed;
+    uint32_t popped;
+    uint32_t overruns;
+    uint32_t producer_waits;
+    uint32_t consumer_waits;
+    uint32_t depth_max;
+} spsc_ring_stats_t;
+
+// 单生产者/单消费者帧描述符环形队列，只传递 thermal_frame_t 指针，不拷贝帧数据
+// 两种策略都无锁：head 只由生产者移动，tail 只由消费者移动；等待的一方由对端任务通知唤醒
+typedef struct
+{
+    thermal_frame_t *slots[SPSC_RING_CAPACITY];
+    volatile uint32_t head;     // 仅生产者写
+    volatile uint32_t tail;     // 仅消费者写
+    spsc_ring_policy_t policy;
+    TaskHandle_t producer;
+    TaskHandle_t consumer;
+    spsc_ring_stats_t stats;
+} spsc_ring_t;
+
+void spsc_ring_init(spsc_ring_t *ring, spsc_ring_policy_t policy);
+// 返回 false（仅 BLOCK 等待超时）时帧的引用仍归调用者；DROP_NEWEST 丢帧时已归还帧池，返回 true
+bool spsc_ring_push(spsc_ring_t *ring, thermal_frame_t *frame, TickType_t timeout);
+thermal_frame_t *spsc_ring_pop(spsc_ring_t *ring, TickType_t timeout);
+uint32_t spsc_ring_depth(const spsc_ring_t *ring);
+
+#endif
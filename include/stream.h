@@ -0,0 +1,45 @@
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include <stdint.h>
+#include "include/frame_pool.h"
+#include "include/stream_format.h"
+#include "include/roi.h"
+
+// USB CDC 二进制帧流：生产者只把整包放入流缓冲区，满了整包丢弃，从不阻塞
+// 发送任务把缓冲区内容写入 CDC；printf 仍只走 UART
+// 仅在 THERMAL_STREAM=1 时有效，否则为空操作
+#define STREAM_BUFFER_BYTES (4 * 1024)
+#define STREAM_CHUNK_BYTES 256
+
+// 流内容：温度场或原始子页
+#define STREAM_MODE_TEMPERATURE 0
+#define STREAM_MODE_RAW 1
+#ifndef THERMAL_STREAM_MODE
+#define THERMAL_STREAM_MODE STREAM_MODE_TEMPERATURE
+#endif
+
+// 原始流不经过流缓冲区：队列里只放帧指针，发送任务直接从帧池中的帧组包写入 CDC
+// 帧池为此多备 队列 + 发送中 1 帧
+#define STREAM_RAW_QUEUE_LENGTH 2
+#if THERMAL_STREAM && THERMAL_STREAM_MODE == STREAM_MODE_RAW
+#define STREAM_POOL_FRAMES (STREAM_RAW_QUEUE_LENGTH + 1)
+#else
+#define STREAM_POOL_FRAMES 0
+#endif
+
+typedef struct
+{
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t dropped;       // 缓冲区满时丢弃的包
+    uint32_t disconnected;  // 主机未打开串口时跳过的包
+} stream_stats_t;
+
+void stream_init(void);
+void stream_send_temperatures(uint32_t sequence, const thermal_temp_t *to);
+void stream_send_raw(thermal_frame_t *frame);
+void stream_send_roi(uint32_t sequence, const roi_stats_t *stats, int count);
+void stream_get_stats(stream_stats_t *stats);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef _STREAM_FORMAT_H_
+#define _STREAM_FORMAT_H_
+
+#include <stdint.h>
+
+// USB CDC 二进制帧流格式，固件和主机端接收工具共用，全部小端
+// 包 = 包头 + 载荷 + CRC16（CCITT-FALSE，覆盖包头和载荷）
+#define STREAM_SYNC 0x49545AA5          // 字节流 A5 5A 54 49
+#define STREAM_VERSION 1
+
+#define STREAM_TYPE_TEMPERATURE 0x01    // int16[768]，0.01°C，传感器行优先顺序
+#define STREAM_TYPE_RAW 0x02            // uint16 frameData[834]
+#define STREAM_TYPE_ROI 0x03            // stream_roi_t[STREAM_ROI_NUM]，序号与同一帧的温度包相同
+
+#define STREAM_PIXEL_NUM 768
+#define STREAM_FRAME_WORDS 834
+#define STREAM_ROI_NUM 8
+
+// ROI 统计，温度单位 0.01°C，像素号为传感器行优先顺序；count 为 0 的项未使用
+typedef struct __attribute__((packed))
+{
+    uint16_t count;
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    uint16_t stddev;
+    uint16_t min_pixel;
+    uint16_t max_pixel;
+} stream_roi_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t sync;
+    uint8_t version;
+    uint8_t type;
+    uint16_t length;        // 载荷字节数
+    uint32_t sequence;
+    uint32_t time_ms;
+} stream_header_t;
+
+#define STREAM_PACKET_MAX (sizeof(stream_header_t) + STREAM_FRAME_WORDS * 2 + 2)
+
+static inline uint16_t stream_crc16(uint16_t crc, const uint8_t *data, int length)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+
+    for (int i = 0; i < length; i++)
+    {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+#endif
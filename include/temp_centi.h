@@ -0,0 +1,50 @@
+#ifndef _TEMP_CENTI_H_
+#define _TEMP_CENTI_H_
+
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+
+// 紧凑温度场：int16，单位 0.01°C，范围 ±327.67°C，与流格式 STREAM_TYPE_TEMPERATURE 相同
+// NaN 和低于下限的值存成 TEMP_CENTI_INVALID，着色时与浮点 NaN 一样落到索引 0
+#define TEMP_CENTI_SCALE 100
+#define TEMP_CENTI_INVALID INT16_MIN
+
+// THERMAL_TEMP_CENTI=1 时帧内温度场及其后各级都用紧凑格式，只有 To 计算本身用浮点
+#ifndef THERMAL_TEMP_CENTI
+#define THERMAL_TEMP_CENTI 0
+#endif
+
+#if THERMAL_TEMP_CENTI
+typedef int16_t thermal_temp_t;
+#define THERMAL_TEMP_CENTI_OF(t) ((int32_t)(t))
+#define THERMAL_TEMP_Q8(t) (((int32_t)(t) * 64) / 25)
+#define THERMAL_TEMP_FROM_Q8(q) ((thermal_temp_t)(((q) * 25) / 64))
+#define THERMAL_TEMP_FLOAT(t) ((t) * (1.0f / TEMP_CENTI_SCALE))
+#else
+typedef float thermal_temp_t;
+#define THERMAL_TEMP_CENTI_OF(t) ((int32_t)temp_to_centi(t))   // NaN 得到 TEMP_CENTI_INVALID，不直接转整数
+#define THERMAL_TEMP_Q8(t) ((int32_t)((t) * 256.0f))
+#define THERMAL_TEMP_FROM_Q8(q) ((q) * (1.0f / 256.0f))
+#define THERMAL_TEMP_FLOAT(t) (t)
+#endif
+
+// 四舍五入并饱和，结果与原来流发送时的 lroundf 相同
+static inline int16_t temp_to_centi(float temp)
+{
+    float t = temp * TEMP_CENTI_SCALE;
+    if (!(t > INT16_MIN)) return TEMP_CENTI_INVALID;
+    if (t > INT16_MAX) return INT16_MAX;
+    return (int16_t)(t >= 0.0f ? t + 0.5f : t - 0.5f);
+}
+
+static inline float temp_from_centi(int16_t centi)
+{
+    return centi * (1.0f / TEMP_CENTI_SCALE);
+}
+
+void temp_centi_from_float(const float *to, int16_t *centi, int count);
+void temp_centi_to_float(const int16_t *centi, float *to, int count);
+void temp_centi_update(uint16_t *frameData, const float *to, int16_t *centi);
+void temp_centi_bad_pixel_apply(const badPixelPlanMLX90640 *plan, int16_t *to);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _TEMPORAL_FILTER_H_
+#define _TEMPORAL_FILTER_H_
+
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+#include "include/temp_centi.h"
+
+// 逐像素时域滤波，定点 Q8（1/256°C）运算；场景变化大的像素自动减弱平滑
+typedef enum
+{
+    TEMPORAL_FILTER_OFF = 0,
+    TEMPORAL_FILTER_EMA = 1,        // 指数滑动平均，增益随帧间变化自适应
+    TEMPORAL_FILTER_KALMAN = 2,     // 简化卡尔曼，每像素一个误差方差
+} temporal_filter_mode_t;
+
+typedef struct
+{
+    temporal_filter_mode_t mode;
+    uint16_t min_gain;          // EMA 静止时的增益，Q8（256 = 不滤波）
+    int32_t motion_low;         // 帧间变化低于此值视为噪声，Q8 °C
+    uint8_t motion_shift;       // 增益在 motion_low ~ motion_low + (1 << motion_shift) 内线性升到 256
+    int32_t process_noise;      // KALMAN 过程噪声 Q，Q8 °C^2
+    int32_t measure_noise;      // KALMAN 测量噪声 R，Q8 °C^2
+} temporal_filter_config_t;
+
+#define TEMPORAL_FILTER_DEFAULT_CONFIG {TEMPORAL_FILTER_EMA, 48, 64, 9, 4, 64}
+
+void temporal_filter_init(const temporal_filter_config_t *config);
+void temporal_filter_apply(uint16_t *frameData, const thermal_temp_t *to, thermal_temp_t *result);
+
+#endif
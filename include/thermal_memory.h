@@ -0,0 +1,57 @@
+#ifndef _THERMAL_MEMORY_H_
+#define _THERMAL_MEMORY_H_
+
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+#include "include/frame_pool.h"
+#include "include/upscale.h"
+#include "include/temp_centi.h"
+#include "include/stream.h"
+#include "include/recorder.h"
+
+#define THERMAL_IMAGE_WIDTH 96
+#define THERMAL_IMAGE_HEIGHT 72
+
+#define MAIN_TASK_STACK_WORDS 1024
+#define ACQ_TASK_STACK_WORDS 1024
+#define DIAG_TASK_STACK_WORDS 1024
+#define RECORDER_TASK_STACK_WORDS 512
+#define STREAM_TASK_STACK_WORDS 512
+
+// 静态场景增量 To，默认关闭，开启后状态表也放进 arena
+#ifndef THERMAL_LAZY_TO
+#define THERMAL_LAZY_TO 0
+#endif
+
+// 采集中 1 帧 + 队列 2 帧 + 处理中 2 帧（当前帧和保留的上一帧），再加各消费者引用的帧
+#define FRAME_POOL_SIZE (5 + STREAM_POOL_FRAMES + RECORDER_POOL_FRAMES)
+
+// 所有帧缓冲集中在一个静态区域，链接时即可确定内存占用
+#define THERMAL_ARENA_BUDGET (56 * 1024)
+
+typedef struct
+{
+    uint16_t eeData[MLX90640_EEPROM_DUMP_NUM];
+    thermal_frame_t frames[FRAME_POOL_SIZE];
+    thermal_temp_t temperatures[MLX90640_PIXEL_NUM];    // 坏点修正后、滤波前的温度场，未刷新的一半沿用上一帧
+    thermal_temp_t display[MLX90640_PIXEL_NUM];     // 滤波和去隔行后的显示温度场，与 temperatures 同格式
+#if THERMAL_TEMP_CENTI
+    float to_work[MLX90640_PIXEL_NUM];      // 帧内只存紧凑温度场，To 在这里算并跨帧保留
+#endif
+    offsetCacheMLX90640 offset_cache;
+#if THERMAL_LAZY_TO
+    lazyToMLX90640 lazy_to;
+#endif
+    uint16_t color[MLX90640_PIXEL_NUM];
+    uint8_t palette_index[MLX90640_PIXEL_NUM];
+    int16_t upscale_rows[UPSCALE_SRC_H * UPSCALE_DST_W];
+    uint16_t frame_buffer[THERMAL_IMAGE_WIDTH * THERMAL_IMAGE_HEIGHT];
+} thermal_arena_t;
+
+_Static_assert(sizeof(thermal_arena_t) <= THERMAL_ARENA_BUDGET, "thermal arena exceeds THERMAL_ARENA_BUDGET");
+
+extern thermal_arena_t thermal_arena;
+
+void thermal_memory_report(void);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef _UPSCALE_H_
+#define _UPSCALE_H_
+
+#include <stdint.h>
+
+// 32x24 -> 96x72 的整数放大，输入为调色板索引（0~255），输出直接查表为 RGB565
+// 权重表在 upscale_init 中一次算好，运行时只有整数乘加
+#define UPSCALE_SRC_W 32
+#define UPSCALE_SRC_H 24
+#define UPSCALE_DST_W 96
+#define UPSCALE_DST_H 72
+
+typedef enum
+{
+    UPSCALE_BILINEAR = 0,       // 原 bilinear_scale，对 RGB565 分量做浮点插值
+    UPSCALE_BICUBIC = 1,        // Catmull-Rom 三次卷积
+    UPSCALE_EDGE_DIRECTED = 2,  // 按边缘方向锐化的双线性
+    UPSCALE_LANCZOS2 = 3,       // 2 瓣 Lanczos
+    UPSCALE_KERNEL_NUM
+} upscale_kernel_t;
+
+void upscale_init(void);
+void upscale_to_rgb565(upscale_kernel_t kernel, const uint8_t *src, const uint16_t *lut, int16_t *rows, uint16_t *dst);
+uint32_t upscale_sharpness(const uint16_t *img);
+// 原有的 RGB565 分量浮点双线性放大
+void bilinear_scale(const uint16_t *src, uint16_t *dst, int srcW, int srcH, int dstW, int dstH);
+
+#endif
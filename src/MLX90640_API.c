@@ -17,6 +17,8 @@
 #include <include/MLX90640_I2C_Driver.h>
 #include <include/MLX90640_API.h>
 #include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
 
 static void ExtractVDDParameters(uint16_t *eeData, paramsMLX90640 *mlx90640);
 static void ExtractPTATParameters(uint16_t *eeData, paramsMLX90640 *mlx90640);
@@ -35,8 +37,22 @@ static int ExtractDeviatingPixels(uint16_t *eeData, paramsMLX90640 *mlx90640);
 static int CheckAdjacentPixels(uint16_t pix1, uint16_t pix2);  
 static float GetMedian(float *values, int n);
 static int IsPixelBad(uint16_t pixel,paramsMLX90640 *params);
+static int IsPixelInPlan(uint16_t pixel, const badPixelPlanMLX90640 *plan);
 static int ValidateFrameData(uint16_t *frameData);
 static int ValidateAuxData(uint16_t *auxData);
+static int ReadControlRegister(uint8_t slaveAddr, uint16_t *value);
+static int WriteControlRegister(uint8_t slaveAddr, uint16_t value);
+static int FrameRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nMemAddressRead, uint16_t *data);
+static int WaitDataReady(uint8_t slaveAddr, uint16_t *statusRegister);
+static float CalculateTa(uint16_t *frameData, const paramsMLX90640 *params, float vdd);
+static void CalculateToPixels(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, const toPaletteMLX90640 *palette, int firstPixel, int lastPixel, float *result);
+static void PaletteStore(const toPaletteMLX90640 *palette, int pixelNumber, float to);
+
+// 控制寄存器只由本文件写入，缓存最近一次写入值，取帧时不再每帧读回
+// 任何 I2C 错误或帧校验失败都会作废缓存，下一次重新读取
+static uint16_t controlRegisterCache;
+static uint8_t controlRegisterCached;
+static transferStatsMLX90640 transferStats;
   
 int MLX90640_DumpEE(uint8_t slaveAddr, uint16_t *eeData)
 {
@@ -74,18 +90,20 @@ int MLX90640_TriggerMeasurement(uint8_t slaveAddr)
     int error = 1;
     uint16_t ctrlReg;
     
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &ctrlReg);
+    error = ReadControlRegister(slaveAddr, &ctrlReg);
     
     if ( error != MLX90640_NO_ERROR) 
     {
         return error;
     }    
                                                 
-    ctrlReg |= MLX90640_CTRL_TRIG_READY_MASK;
-    error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, ctrlReg);
+    // 触发位由器件自行清零，不进入缓存
+    transferStats.transactions++;
+    error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, ctrlReg | MLX90640_CTRL_TRIG_READY_MASK);
     
     if ( error != MLX90640_NO_ERROR)
     {
+        controlRegisterCached = 0;
         return error;
     }    
     
@@ -96,7 +114,7 @@ int MLX90640_TriggerMeasurement(uint8_t slaveAddr)
         return error;
     }    
     
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &ctrlReg);
+    error = FrameRead(slaveAddr, MLX90640_CTRL_REG, 1, &ctrlReg);
     
     if ( error != MLX90640_NO_ERROR)
     {
@@ -110,73 +128,237 @@ int MLX90640_TriggerMeasurement(uint8_t slaveAddr)
     
     return MLX90640_NO_ERROR;    
 }
-    
+
+//------------------------------------------------------------------------------
+
+// 辅助数据直接读入 frameData[768..831] 并就地校验，控制寄存器取缓存值
+// 传输次数：轮询若干次 + 清状态 1 次 + 像素 1 次 + 辅助 1 次
 int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
 {
-    uint16_t dataReady = 0;
     uint16_t controlRegister1;
     uint16_t statusRegister;
     int error = 1;
-    uint16_t data[64];
-    uint8_t cnt = 0;
-    
-    while(dataReady == 0)
-    {
-        error = MLX90640_I2CRead(slaveAddr, MLX90640_STATUS_REG, 1, &statusRegister);
-        if(error != MLX90640_NO_ERROR)
-        {
-            return error;
-        }    
-        //dataReady = statusRegister & 0x0008;
-        dataReady = MLX90640_GET_DATA_READY(statusRegister); 
-    }      
+    uint32_t transactions = transferStats.transactions;
+    uint32_t statusPolls = transferStats.statusPolls;
     
-    error = MLX90640_I2CWrite(slaveAddr, MLX90640_STATUS_REG, MLX90640_INIT_STATUS_VALUE);
-    if(error == -MLX90640_I2C_NACK_ERROR)
+    error = WaitDataReady(slaveAddr, &statusRegister);
+    if(error != MLX90640_NO_ERROR)
     {
         return error;
     }
                      
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_PIXEL_DATA_START_ADDRESS, MLX90640_PIXEL_NUM, frameData); 
+    error = FrameRead(slaveAddr, MLX90640_PIXEL_DATA_START_ADDRESS, MLX90640_PIXEL_NUM, frameData); 
     if(error != MLX90640_NO_ERROR)
     {
         return error;
     }                       
     
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_AUX_DATA_START_ADDRESS, MLX90640_AUX_NUM, data); 
+    error = FrameRead(slaveAddr, MLX90640_AUX_DATA_START_ADDRESS, MLX90640_AUX_NUM, &frameData[MLX90640_PIXEL_NUM]); 
     if(error != MLX90640_NO_ERROR)
     {
         return error;
     }     
         
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_CTRL_REG, 1, &controlRegister1);
+    error = ReadControlRegister(slaveAddr, &controlRegister1);
+    if(error != MLX90640_NO_ERROR)
+    {
+        return error;
+    }
     frameData[832] = controlRegister1;
     //frameData[833] = statusRegister & 0x0001;
     frameData[833] = MLX90640_GET_FRAME(statusRegister);
     
-    if(error != MLX90640_NO_ERROR)
+    transferStats.frames++;
+    transferStats.lastTransactions = transferStats.transactions - transactions;
+    transferStats.lastStatusPolls = transferStats.statusPolls - statusPolls;
+    
+    error = ValidateAuxData(&frameData[MLX90640_PIXEL_NUM]);
+    if(error == MLX90640_NO_ERROR)
+    {
+        error = ValidateFrameData(frameData);
+    }
+    if (error != MLX90640_NO_ERROR)
     {
+        controlRegisterCached = 0;
         return error;
     }
     
-    error = ValidateAuxData(data);
-    if(error == MLX90640_NO_ERROR)
+    return frameData[833];    
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_GetTransferStats(transferStatsMLX90640 *stats)
+{
+    *stats = transferStats;
+}
+
+//------------------------------------------------------------------------------
+
+// 隔行模式下每个子页只更新奇数行或偶数行，只按行突发读取当前子页的 12 行，
+// 辅助区只读计算用到的 Vbe~增益（768~778）和 PTAT~Vdd（800~810）两段
+// 未读取的像素行和辅助字保持调用者缓冲区原值，后续各级只使用当前子页的像素
+// 棋盘模式下子页像素分布在所有行，退化为整块读取全部像素
+int MLX90640_GetSubpageData(uint8_t slaveAddr, uint16_t *frameData)
+{
+    uint16_t controlRegister1;
+    uint16_t statusRegister;
+    int error = 1;
+    int subPage;
+    uint32_t transactions = transferStats.transactions;
+    uint32_t statusPolls = transferStats.statusPolls;
+
+    error = WaitDataReady(slaveAddr, &statusRegister);
+    if(error != MLX90640_NO_ERROR)
+    {
+        return error;
+    }
+
+    error = ReadControlRegister(slaveAddr, &controlRegister1);
+    if(error != MLX90640_NO_ERROR)
+    {
+        return error;
+    }
+    subPage = MLX90640_GET_FRAME(statusRegister);
+    frameData[832] = controlRegister1;
+    frameData[833] = subPage;
+
+    if(MLX90640_IS_CHESS_MODE(frameData))
     {
-        for(cnt=0; cnt<MLX90640_AUX_NUM; cnt++)
+        error = FrameRead(slaveAddr, MLX90640_PIXEL_DATA_START_ADDRESS, MLX90640_PIXEL_NUM, frameData);
+        if(error != MLX90640_NO_ERROR)
         {
-            frameData[cnt+MLX90640_PIXEL_NUM] = data[cnt];
+            return error;
         }
-    }        
-    
-    error = ValidateFrameData(frameData);
+    }
+    else
+    {
+        for(int line = subPage; line < MLX90640_LINE_NUM; line += 2)
+        {
+            error = FrameRead(slaveAddr, MLX90640_PIXEL_DATA_START_ADDRESS + line * MLX90640_LINE_SIZE,
+                                     MLX90640_LINE_SIZE, &frameData[line * MLX90640_LINE_SIZE]);
+            if(error != MLX90640_NO_ERROR)
+            {
+                return error;
+            }
+        }
+    }
+
+    error = FrameRead(slaveAddr, MLX90640_AUX_DATA_START_ADDRESS, 11, &frameData[768]);
+    if(error != MLX90640_NO_ERROR)
+    {
+        return error;
+    }
+    error = FrameRead(slaveAddr, MLX90640_AUX_DATA_START_ADDRESS + 32, 11, &frameData[800]);
+    if(error != MLX90640_NO_ERROR)
+    {
+        return error;
+    }
+
+    transferStats.frames++;
+    transferStats.lastTransactions = transferStats.transactions - transactions;
+    transferStats.lastStatusPolls = transferStats.statusPolls - statusPolls;
+
+    // 与 ValidateAuxData 相同的判据，只检查读取到的字
+    error = MLX90640_NO_ERROR;
+    if(frameData[768] == 0x7FFF || frameData[800] == 0x7FFF) error = -MLX90640_FRAME_DATA_ERROR;
+    for(int i=776; i<779; i++)
+    {
+        if(frameData[i] == 0x7FFF || frameData[i + 32] == 0x7FFF) error = -MLX90640_FRAME_DATA_ERROR;
+    }
+    if(error == MLX90640_NO_ERROR)
+    {
+        error = ValidateFrameData(frameData);
+    }
     if (error != MLX90640_NO_ERROR)
     {
+        controlRegisterCached = 0;
         return error;
     }
+
+    return subPage;
+}
+
+static int FrameRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nMemAddressRead, uint16_t *data)
+{
+    int error;
     
-    return frameData[833];    
+    transferStats.transactions++;
+    error = MLX90640_I2CRead(slaveAddr, startAddress, nMemAddressRead, data);
+    if(error != MLX90640_NO_ERROR)
+    {
+        controlRegisterCached = 0;
+    }
+    
+    return error;
+}
+
+//------------------------------------------------------------------------------
+
+// 轮询数据就绪后清除状态寄存器
+static int WaitDataReady(uint8_t slaveAddr, uint16_t *statusRegister)
+{
+    uint16_t dataReady = 0;
+    int error;
+    
+    while(dataReady == 0)
+    {
+        transferStats.statusPolls++;
+        error = FrameRead(slaveAddr, MLX90640_STATUS_REG, 1, statusRegister);
+        if(error != MLX90640_NO_ERROR)
+        {
+            return error;
+        }    
+        dataReady = MLX90640_GET_DATA_READY(*statusRegister); 
+    }      
+    
+    transferStats.transactions++;
+    error = MLX90640_I2CWrite(slaveAddr, MLX90640_STATUS_REG, MLX90640_INIT_STATUS_VALUE);
+    if(error == -MLX90640_I2C_NACK_ERROR)
+    {
+        return error;
+    }
+    
+    return MLX90640_NO_ERROR;
+}
+
+//------------------------------------------------------------------------------
+
+static int ReadControlRegister(uint8_t slaveAddr, uint16_t *value)
+{
+    int error;
+    
+    if(controlRegisterCached)
+    {
+        *value = controlRegisterCache;
+        return MLX90640_NO_ERROR;
+    }
+    
+    error = FrameRead(slaveAddr, MLX90640_CTRL_REG, 1, value);
+    if(error == MLX90640_NO_ERROR)
+    {
+        controlRegisterCache = *value & ~MLX90640_CTRL_TRIG_READY_MASK;
+        controlRegisterCached = 1;
+    }
+    
+    return error;
+}
+
+//------------------------------------------------------------------------------
+
+static int WriteControlRegister(uint8_t slaveAddr, uint16_t value)
+{
+    int error;
+    
+    error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);
+    controlRegisterCache = value & ~MLX90640_CTRL_TRIG_READY_MASK;
+    controlRegisterCached = (error == MLX90640_NO_ERROR);
+    
+    return error;
 }
 
+//------------------------------------------------------------------------------
+
 static int ValidateFrameData(uint16_t *frameData)
 {
     uint8_t line = 0;
@@ -269,7 +451,7 @@ int MLX90640_SetResolution(uint8_t slaveAddr, uint8_t resolution)
     if(error == MLX90640_NO_ERROR)
     {
         value = (controlRegister1 & MLX90640_CTRL_RESOLUTION_MASK) | value;
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);        
+        error = WriteControlRegister(slaveAddr, value);        
     }    
     
     return error;
@@ -309,7 +491,7 @@ int MLX90640_SetRefreshRate(uint8_t slaveAddr, uint8_t refreshRate)
     if(error == MLX90640_NO_ERROR)
     {
         value = (controlRegister1 & MLX90640_CTRL_REFRESH_MASK) | value;
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);
+        error = WriteControlRegister(slaveAddr, value);
     }    
     
     return error;
@@ -346,7 +528,7 @@ int MLX90640_SetInterleavedMode(uint8_t slaveAddr)
     if(error == 0)
     {
         value = (controlRegister1 & ~MLX90640_CTRL_MEAS_MODE_MASK);
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);        
+        error = WriteControlRegister(slaveAddr, value);        
     }    
     
     return error;
@@ -365,7 +547,7 @@ int MLX90640_SetChessMode(uint8_t slaveAddr)
     if(error == 0)
     {
         value = (controlRegister1 | MLX90640_CTRL_MEAS_MODE_MASK);
-        error = MLX90640_I2CWrite(slaveAddr, MLX90640_CTRL_REG, value);        
+        error = WriteControlRegister(slaveAddr, value);        
     }    
     
     return error;
@@ -392,74 +574,177 @@ int MLX90640_GetCurMode(uint8_t slaveAddr)
 //------------------------------------------------------------------------------
 
 void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, float *result)
+{
+    frameContextMLX90640 context;
+    
+    MLX90640_PrepareTo(frameData, params, emissivity, tr, &context);
+    MLX90640_CalculateToRange(frameData, params, &context, 0, MLX90640_PIXEL_NUM, result);
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_PrepareTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, frameContextMLX90640 *context)
+{
+    MLX90640_PrepareFrame(frameData, params, context);
+    MLX90640_PrepareToContext(context, emissivity, tr);
+}
+
+//------------------------------------------------------------------------------
+
+// Vdd 只算一次，Ta 直接用这个 Vdd，不再像 GetTa 那样重新计算
+void MLX90640_PrepareFrame(uint16_t *frameData, const paramsMLX90640 *params, frameContextMLX90640 *context)
 {
     float vdd;
     float ta;
     float ta4;
-    float tr4;
-    float taTr;
     float gain;
-    float irDataCP[2];
-    float irData;
-    float alphaCompensated;
-    uint8_t mode;
-    int8_t ilPattern;
-    int8_t chessPattern;
-    int8_t pattern;
-    int8_t conversionPattern;
-    float Sx;
-    float To;
-    float alphaCorrR[4];
-    int8_t range;
-    uint16_t subPage;
-    float ktaScale;
-    float kvScale;
-    float alphaScale;
-    float kta;
-    float kv;
     
-    subPage = frameData[833];
+    context->subPage = frameData[833];
+    context->offsetCompensated = NULL;
     vdd = MLX90640_GetVdd(frameData, params);
-    ta = MLX90640_GetTa(frameData, params);
+    ta = CalculateTa(frameData, params, vdd);
+    context->vdd = vdd;
+    context->ta = ta;
     
     ta4 = (ta + 273.15);
     ta4 = ta4 * ta4;
     ta4 = ta4 * ta4;
-    tr4 = (tr + 273.15);
-    tr4 = tr4 * tr4;
-    tr4 = tr4 * tr4;
-    taTr = tr4 - (tr4-ta4)/emissivity;
+    context->ta4 = ta4;
     
-    ktaScale = POW2(params->ktaScale);
-    kvScale = POW2(params->kvScale);
-    alphaScale = POW2(params->alphaScale);
+    context->ktaScale = POW2(params->ktaScale);
+    context->kvScale = POW2(params->kvScale);
+    context->alphaScale = POW2(params->alphaScale);
     
-    alphaCorrR[0] = 1 / (1 + params->ksTo[0] * 40);
-    alphaCorrR[1] = 1 ;
-    alphaCorrR[2] = (1 + params->ksTo[1] * params->ct[2]);
-    alphaCorrR[3] = alphaCorrR[2] * (1 + params->ksTo[2] * (params->ct[3] - params->ct[2]));
+    context->alphaCorrR[0] = 1 / (1 + params->ksTo[0] * 40);
+    context->alphaCorrR[1] = 1 ;
+    context->alphaCorrR[2] = (1 + params->ksTo[1] * params->ct[2]);
+    context->alphaCorrR[3] = context->alphaCorrR[2] * (1 + params->ksTo[2] * (params->ct[3] - params->ct[2]));
     
 //------------------------- Gain calculation -----------------------------------    
     
     gain = (float)params->gainEE / (int16_t)frameData[778]; 
+    context->gain = gain;
   
-//------------------------- To calculation -------------------------------------    
-    mode = (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> 5;
+//------------------------- Compensation pixels --------------------------------    
+    context->mode = (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> 5;
     
-    irDataCP[0] = (int16_t)frameData[776] * gain;
-    irDataCP[1] = (int16_t)frameData[808] * gain;
+    context->irDataCP[0] = (int16_t)frameData[776] * gain;
+    context->irDataCP[1] = (int16_t)frameData[808] * gain;
     
-    irDataCP[0] = irDataCP[0] - params->cpOffset[0] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
-    if( mode ==  params->calibrationModeEE)
+    context->irDataCP[0] = context->irDataCP[0] - params->cpOffset[0] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
+    if( context->mode ==  params->calibrationModeEE)
     {
-        irDataCP[1] = irDataCP[1] - params->cpOffset[1] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
+        context->irDataCP[1] = context->irDataCP[1] - params->cpOffset[1] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
     }
     else
     {
-      irDataCP[1] = irDataCP[1] - (params->cpOffset[1] + params->ilChessC[0]) * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
+      context->irDataCP[1] = context->irDataCP[1] - (params->cpOffset[1] + params->ilChessC[0]) * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
     }
+}
 
-    for( int pixelNumber = 0; pixelNumber < 768; pixelNumber++)
+//------------------------------------------------------------------------------
+
+void MLX90640_PrepareToContext(frameContextMLX90640 *context, float emissivity, float tr)
+{
+    float tr4;
+    
+    context->emissivity = emissivity;
+    context->tr = tr;
+    tr4 = (tr + 273.15);
+    tr4 = tr4 * tr4;
+    tr4 = tr4 * tr4;
+    context->taTr = tr4 - (tr4-context->ta4)/emissivity;
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_OffsetCacheInit(offsetCacheMLX90640 *cache, float taQuantum, float vddQuantum)
+{
+    cache->taQuantum = taQuantum;
+    cache->vddQuantum = vddQuantum;
+    cache->valid = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+//------------------------------------------------------------------------------
+
+// 命中时补偿值对应的 Ta/Vdd 与当前值相差不足一个量化步长
+void MLX90640_OffsetCacheUpdate(offsetCacheMLX90640 *cache, const paramsMLX90640 *params, frameContextMLX90640 *context)
+{
+    float ta = context->ta;
+    float vdd = context->vdd;
+    float kta;
+    float kv;
+    
+    if(cache->valid && fabsf(ta - cache->ta) < cache->taQuantum && fabsf(vdd - cache->vdd) < cache->vddQuantum)
+    {
+        cache->hits++;
+    }
+    else
+    {
+        for( int pixelNumber = 0; pixelNumber < MLX90640_PIXEL_NUM; pixelNumber++)
+        {
+            kta = params->kta[pixelNumber]/context->ktaScale;
+            kv = params->kv[pixelNumber]/context->kvScale;
+            cache->compensated[pixelNumber] = params->offset[pixelNumber]*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
+        }
+        cache->ta = ta;
+        cache->vdd = vdd;
+        cache->valid = 1;
+        cache->misses++;
+    }
+    
+    context->offsetCompensated = cache->compensated;
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_CalculateToRange(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, int firstPixel, int lastPixel, float *result)
+{
+    CalculateToPixels(frameData, params, context, NULL, firstPixel, lastPixel, result);
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_CalculateToPaletteRange(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, const toPaletteMLX90640 *palette, int firstPixel, int lastPixel, float *result)
+{
+    CalculateToPixels(frameData, params, context, palette, firstPixel, lastPixel, result);
+}
+
+//------------------------------------------------------------------------------
+
+static void CalculateToPixels(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, const toPaletteMLX90640 *palette, int firstPixel, int lastPixel, float *result)
+{
+    float ta;
+    float vdd;
+    float taTr;
+    float gain;
+    float emissivity;
+    float irData;
+    float alphaCompensated;
+    uint8_t mode;
+    int8_t ilPattern;
+    int8_t chessPattern;
+    int8_t pattern;
+    int8_t conversionPattern;
+    float Sx;
+    float To;
+    int8_t range;
+    uint16_t subPage;
+    float kta;
+    float kv;
+    
+    const float *offsetCompensated = context->offsetCompensated;
+    ta = context->ta;
+    vdd = context->vdd;
+    taTr = context->taTr;
+    gain = context->gain;
+    emissivity = context->emissivity;
+    mode = context->mode;
+    subPage = context->subPage;
+
+    for( int pixelNumber = firstPixel; pixelNumber < lastPixel; pixelNumber++)
     {
         ilPattern = pixelNumber / 32 - (pixelNumber / 64) * 2; 
         chessPattern = ilPattern ^ (pixelNumber - (pixelNumber/2)*2); 
@@ -478,19 +763,26 @@ void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, flo
         {    
             irData = (int16_t)frameData[pixelNumber] * gain;
             
-            kta = params->kta[pixelNumber]/ktaScale;
-            kv = params->kv[pixelNumber]/kvScale;
-            irData = irData - params->offset[pixelNumber]*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
+            if(offsetCompensated != NULL)
+            {
+                irData = irData - offsetCompensated[pixelNumber];
+            }
+            else
+            {
+                kta = params->kta[pixelNumber]/context->ktaScale;
+                kv = params->kv[pixelNumber]/context->kvScale;
+                irData = irData - params->offset[pixelNumber]*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
+            }
             
             if(mode !=  params->calibrationModeEE)
             {
               irData = irData + params->ilChessC[2] * (2 * ilPattern - 1) - params->ilChessC[1] * conversionPattern; 
             }                       
     
-            irData = irData - params->tgc * irDataCP[subPage];
+            irData = irData - params->tgc * context->irDataCP[subPage];
             irData = irData / emissivity;
             
-            alphaCompensated = SCALEALPHA*alphaScale/params->alpha[pixelNumber];
+            alphaCompensated = SCALEALPHA*context->alphaScale/params->alpha[pixelNumber];
             alphaCompensated = alphaCompensated*(1 + params->KsTa * (ta - 25));
                         
             Sx = alphaCompensated * alphaCompensated * alphaCompensated * (irData + alphaCompensated * taTr);
@@ -515,9 +807,144 @@ void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, flo
                 range = 3;            
             }      
             
-            To = sqrt(sqrt(irData / (alphaCompensated * alphaCorrR[range] * (1 + params->ksTo[range] * (To - params->ct[range]))) + taTr)) - 273.15;
+            To = sqrt(sqrt(irData / (alphaCompensated * context->alphaCorrR[range] * (1 + params->ksTo[range] * (To - params->ct[range]))) + taTr)) - 273.15;
                         
             result[pixelNumber] = To;
+            
+            if(palette != NULL)
+            {
+                PaletteStore(palette, pixelNumber, To);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// 量化方式与 palette_index 一致，NaN 落到 0
+static void PaletteStore(const toPaletteMLX90640 *palette, int pixelNumber, float to)
+{
+    uint8_t index;
+    
+    if(!(to >= palette->minTemp))
+    {
+        index = 0;
+    }
+    else if(to > palette->maxTemp)
+    {
+        index = 255;
+    }
+    else
+    {
+        index = (to - palette->minTemp) / (palette->maxTemp - palette->minTemp) * 255;
+    }
+    
+    if(palette->mirror)
+    {
+        pixelNumber = pixelNumber ^ (MLX90640_LINE_SIZE - 1);
+    }
+    if(palette->index != NULL)
+    {
+        palette->index[pixelNumber] = index;
+    }
+    if(palette->color != NULL)
+    {
+        palette->color[pixelNumber] = palette->lut[index];
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_LazyToInit(lazyToMLX90640 *lazy, uint16_t noiseFloor, float taQuantum, float vddQuantum)
+{
+    lazy->noiseFloor = noiseFloor;
+    lazy->taQuantum = taQuantum;
+    lazy->vddQuantum = vddQuantum;
+    lazy->valid[0] = 0;
+    lazy->valid[1] = 0;
+    lazy->computed = 0;
+    lazy->skipped = 0;
+    lazy->refreshes = 0;
+}
+
+//------------------------------------------------------------------------------
+
+// 单线程调用，在 PrepareToContext 之后：逐像素决定本子页是否重算并计数，
+// 分核的 CalculateToLazyRange 只读 dirty 位图，不需要再同步计数
+void MLX90640_LazyToPrepare(lazyToMLX90640 *lazy, uint16_t *frameData, const frameContextMLX90640 *context)
+{
+    uint16_t subPage = context->subPage;
+    int16_t gainRaw = (int16_t)frameData[778];
+    int16_t cpRaw = (int16_t)frameData[subPage == 0 ? 776 : 808];
+    int16_t raw;
+    uint32_t dirty;
+    uint32_t computed = 0;
+    uint32_t skipped = 0;
+    int refresh;
+    int delta;
+    int pixelNumber;
+    
+    refresh = !lazy->valid[subPage] || lazy->mode[subPage] != context->mode || lazy->emissivity[subPage] != context->emissivity
+           || fabsf(context->ta - lazy->ta[subPage]) >= lazy->taQuantum
+           || fabsf(context->vdd - lazy->vdd[subPage]) >= lazy->vddQuantum
+           || fabsf(context->tr - lazy->tr[subPage]) >= lazy->taQuantum
+           || abs(gainRaw - lazy->gainRaw[subPage]) > lazy->noiseFloor
+           || abs(cpRaw - lazy->cpRaw[subPage]) > lazy->noiseFloor;
+    
+    if(refresh)
+    {
+        lazy->ta[subPage] = context->ta;
+        lazy->vdd[subPage] = context->vdd;
+        lazy->tr[subPage] = context->tr;
+        lazy->emissivity[subPage] = context->emissivity;
+        lazy->gainRaw[subPage] = gainRaw;
+        lazy->cpRaw[subPage] = cpRaw;
+        lazy->mode[subPage] = context->mode;
+        lazy->valid[subPage] = 1;
+        lazy->refreshes++;
+    }
+    
+    for(int line = 0; line < MLX90640_PIXEL_NUM / 32; line++)
+    {
+        dirty = 0;
+        for(int column = 0; column < 32; column++)
+        {
+            pixelNumber = line * 32 + column;
+            if(MLX90640_PIXEL_PATTERN(pixelNumber, context->mode) != subPage)
+            {
+                continue;
+            }
+            
+            // 只在重算时更新 lastRaw，缓慢漂移累计超过噪声底也会触发重算
+            raw = (int16_t)frameData[pixelNumber];
+            delta = raw - lazy->lastRaw[pixelNumber];
+            if(refresh || delta > lazy->noiseFloor || delta < -lazy->noiseFloor)
+            {
+                lazy->lastRaw[pixelNumber] = raw;
+                dirty |= 1u << column;
+                computed++;
+            }
+            else
+            {
+                skipped++;
+            }
+        }
+        lazy->dirty[line] = dirty;
+    }
+    
+    lazy->computed += computed;
+    lazy->skipped += skipped;
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_CalculateToLazyRange(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, const lazyToMLX90640 *lazy, const toPaletteMLX90640 *palette, int firstPixel, int lastPixel, float *result)
+{
+    for( int pixelNumber = firstPixel; pixelNumber < lastPixel; pixelNumber++)
+    {
+        if(lazy->dirty[pixelNumber >> 5] & (1u << (pixelNumber & 31)))
+        {
+            CalculateToPixels(frameData, params, context, palette, pixelNumber, pixelNumber + 1, result);
         }
     }
 }
@@ -525,11 +952,20 @@ void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, flo
 //------------------------------------------------------------------------------
 
 void MLX90640_GetImage(uint16_t *frameData, const paramsMLX90640 *params, float *result)
+{
+    frameContextMLX90640 context;
+    
+    MLX90640_PrepareFrame(frameData, params, &context);
+    MLX90640_GetImageContext(frameData, params, &context, result);
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_GetImageContext(uint16_t *frameData, const paramsMLX90640 *params, const frameContextMLX90640 *context, float *result)
 {
     float vdd;
     float ta;
     float gain;
-    float irDataCP[2];
     float irData;
     float alphaCompensated;
     uint8_t mode;
@@ -539,38 +975,15 @@ void MLX90640_GetImage(uint16_t *frameData, const paramsMLX90640 *params, float
     int8_t conversionPattern;
     float image;
     uint16_t subPage;
-    float ktaScale;
-    float kvScale;
     float kta;
     float kv;
     
-    subPage = frameData[833];
-    vdd = MLX90640_GetVdd(frameData, params);
-    ta = MLX90640_GetTa(frameData, params);
-    
-    ktaScale = POW2(params->ktaScale);
-    kvScale = POW2(params->kvScale);
-    
-//------------------------- Gain calculation -----------------------------------    
-    
-    gain = (float)params->gainEE / (int16_t)frameData[778]; 
-  
-//------------------------- Image calculation -------------------------------------    
-    
-    mode = (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> 5;
-    
-    irDataCP[0] = (int16_t)frameData[776] * gain;
-    irDataCP[1] = (int16_t)frameData[808] * gain;
-    
-    irDataCP[0] = irDataCP[0] - params->cpOffset[0] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
-    if( mode ==  params->calibrationModeEE)
-    {
-        irDataCP[1] = irDataCP[1] - params->cpOffset[1] * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
-    }
-    else
-    {
-      irDataCP[1] = irDataCP[1] - (params->cpOffset[1] + params->ilChessC[0]) * (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
-    }
+    const float *offsetCompensated = context->offsetCompensated;
+    subPage = context->subPage;
+    vdd = context->vdd;
+    ta = context->ta;
+    gain = context->gain;
+    mode = context->mode;
 
     for( int pixelNumber = 0; pixelNumber < 768; pixelNumber++)
     {
@@ -591,16 +1004,23 @@ void MLX90640_GetImage(uint16_t *frameData, const paramsMLX90640 *params, float
         {    
             irData = (int16_t)frameData[pixelNumber] * gain;
             
-            kta = params->kta[pixelNumber]/ktaScale;
-            kv = params->kv[pixelNumber]/kvScale;
-            irData = irData - params->offset[pixelNumber]*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
+            if(offsetCompensated != NULL)
+            {
+                irData = irData - offsetCompensated[pixelNumber];
+            }
+            else
+            {
+                kta = params->kta[pixelNumber]/context->ktaScale;
+                kv = params->kv[pixelNumber]/context->kvScale;
+                irData = irData - params->offset[pixelNumber]*(1 + kta*(ta - 25))*(1 + kv*(vdd - 3.3));
+            }
 
             if(mode !=  params->calibrationModeEE)
             {
               irData = irData + params->ilChessC[2] * (2 * ilPattern - 1) - params->ilChessC[1] * conversionPattern; 
             }
             
-            irData = irData - params->tgc * irDataCP[subPage];
+            irData = irData - params->tgc * context->irDataCP[subPage];
                         
             alphaCompensated = params->alpha[pixelNumber];
             
@@ -630,14 +1050,18 @@ float MLX90640_GetVdd(uint16_t *frameData, const paramsMLX90640 *params)
 //------------------------------------------------------------------------------
 
 float MLX90640_GetTa(uint16_t *frameData, const paramsMLX90640 *params)
+{
+    return CalculateTa(frameData, params, MLX90640_GetVdd(frameData, params));
+}
+
+//------------------------------------------------------------------------------
+
+static float CalculateTa(uint16_t *frameData, const paramsMLX90640 *params, float vdd)
 {
     int16_t ptat;
     float ptatArt;
-    float vdd;
     float ta;
     
-    vdd = MLX90640_GetVdd(frameData, params);
-    
     ptat = (int16_t)frameData[800];
     
     ptatArt = (ptat / (ptat * params->alphaPTAT + (int16_t)frameData[768])) * POW2(18);
@@ -760,6 +1184,214 @@ void MLX90640_BadPixelsCorrection(uint16_t *pixels, float *to, int mode, paramsM
 
 //------------------------------------------------------------------------------
 
+void MLX90640_BadPixelPlanInit(badPixelPlanMLX90640 *plan)
+{
+    plan->count = 0;
+}
+
+//------------------------------------------------------------------------------
+
+int MLX90640_BadPixelPlanAdd(badPixelPlanMLX90640 *plan, uint16_t pixel, int mode, paramsMLX90640 *params)
+{
+    badPixelFixMLX90640 *fix;
+    uint8_t line;
+    uint8_t column;
+    
+    if(pixel >= MLX90640_PIXEL_NUM)
+    {
+        return -MLX90640_BAD_PIXELS_NUM_ERROR;
+    }
+    
+    if(IsPixelInPlan(pixel, plan))
+    {
+        return MLX90640_NO_ERROR;
+    }
+    
+    if(plan->count >= MLX90640_BAD_PIXELS_MAX)
+    {
+        return -MLX90640_BAD_PIXELS_NUM_ERROR;
+    }
+    
+    fix = &plan->fix[plan->count];
+    fix->pixel = pixel;
+    line = pixel>>5;
+    column = pixel - (line<<5);
+    
+    if(mode == 1)
+    {
+        if(line == 0)
+        {
+            if(column == 0)
+            {
+                fix->method = MLX90640_BAD_PIXEL_COPY;
+                fix->neighbors[0] = 33;
+            }
+            else if(column == 31)
+            {
+                fix->method = MLX90640_BAD_PIXEL_COPY;
+                fix->neighbors[0] = 62;
+            }
+            else
+            {
+                fix->method = MLX90640_BAD_PIXEL_MEAN2;
+                fix->neighbors[0] = pixel+31;
+                fix->neighbors[1] = pixel+33;
+            }
+        }
+        else if(line == 23)
+        {
+            if(column == 0)
+            {
+                fix->method = MLX90640_BAD_PIXEL_COPY;
+                fix->neighbors[0] = 705;
+            }
+            else if(column == 31)
+            {
+                fix->method = MLX90640_BAD_PIXEL_COPY;
+                fix->neighbors[0] = 734;
+            }
+            else
+            {
+                fix->method = MLX90640_BAD_PIXEL_MEAN2;
+                fix->neighbors[0] = pixel-33;
+                fix->neighbors[1] = pixel-31;
+            }
+        }
+        else if(column == 0)
+        {
+            fix->method = MLX90640_BAD_PIXEL_MEAN2;
+            fix->neighbors[0] = pixel-31;
+            fix->neighbors[1] = pixel+33;
+        }
+        else if(column == 31)
+        {
+            fix->method = MLX90640_BAD_PIXEL_MEAN2;
+            fix->neighbors[0] = pixel-33;
+            fix->neighbors[1] = pixel+31;
+        }
+        else
+        {
+            fix->method = MLX90640_BAD_PIXEL_MEDIAN4;
+            fix->neighbors[0] = pixel-33;
+            fix->neighbors[1] = pixel-31;
+            fix->neighbors[2] = pixel+31;
+            fix->neighbors[3] = pixel+33;
+        }
+    }
+    else
+    {
+        if(column == 0)
+        {
+            fix->method = MLX90640_BAD_PIXEL_COPY;
+            fix->neighbors[0] = pixel+1;
+        }
+        else if(column == 1 || column == 30)
+        {
+            fix->method = MLX90640_BAD_PIXEL_MEAN2;
+            fix->neighbors[0] = pixel-1;
+            fix->neighbors[1] = pixel+1;
+        }
+        else if(column == 31)
+        {
+            fix->method = MLX90640_BAD_PIXEL_COPY;
+            fix->neighbors[0] = pixel-1;
+        }
+        else if(IsPixelBad(pixel-2,params) == 0 && IsPixelBad(pixel+2,params) == 0 &&
+                IsPixelInPlan(pixel-2,plan) == 0 && IsPixelInPlan(pixel+2,plan) == 0)
+        {
+            fix->method = MLX90640_BAD_PIXEL_GRADIENT;
+            fix->neighbors[0] = pixel-1;
+            fix->neighbors[1] = pixel-2;
+            fix->neighbors[2] = pixel+1;
+            fix->neighbors[3] = pixel+2;
+        }
+        else
+        {
+            fix->method = MLX90640_BAD_PIXEL_MEAN2;
+            fix->neighbors[0] = pixel-1;
+            fix->neighbors[1] = pixel+1;
+        }
+    }
+    
+    plan->count = plan->count + 1;
+    
+    return MLX90640_NO_ERROR;
+}
+
+//------------------------------------------------------------------------------
+
+int MLX90640_BadPixelPlanAddList(badPixelPlanMLX90640 *plan, uint16_t *pixels, int mode, paramsMLX90640 *params)
+{
+    int error = MLX90640_NO_ERROR;
+    
+    for(int pix = 0; pixels[pix] != 0xFFFF && error == MLX90640_NO_ERROR; pix++)
+    {
+        error = MLX90640_BadPixelPlanAdd(plan, pixels[pix], mode, params);
+    }
+    
+    return error;
+}
+
+//------------------------------------------------------------------------------
+
+void MLX90640_BadPixelPlanApply(const badPixelPlanMLX90640 *plan, float *to)
+{
+    const badPixelFixMLX90640 *fix;
+    float a, b, c, d, t;
+    
+    for(int i = 0; i < plan->count; i++)
+    {
+        fix = &plan->fix[i];
+        switch(fix->method)
+        {
+            case MLX90640_BAD_PIXEL_COPY:
+                to[fix->pixel] = to[fix->neighbors[0]];
+                break;
+            case MLX90640_BAD_PIXEL_MEAN2:
+                to[fix->pixel] = (to[fix->neighbors[0]] + to[fix->neighbors[1]])/2.0;
+                break;
+            case MLX90640_BAD_PIXEL_MEDIAN4:
+                // 中值 = 去掉最小和最大后的中间两个数的均值
+                a = to[fix->neighbors[0]];
+                b = to[fix->neighbors[1]];
+                c = to[fix->neighbors[2]];
+                d = to[fix->neighbors[3]];
+                if(b < a) { t = a; a = b; b = t; }
+                if(d < c) { t = c; c = d; d = t; }
+                if(c < a) { t = a; a = c; c = t; }
+                if(d < b) { t = b; b = d; d = t; }
+                if(c < b) { t = b; b = c; c = t; }
+                to[fix->pixel] = (c + b)/2.0;
+                break;
+            default:
+                a = to[fix->neighbors[2]] - to[fix->neighbors[3]];
+                b = to[fix->neighbors[0]] - to[fix->neighbors[1]];
+                if(fabs(a) > fabs(b))
+                {
+                    to[fix->pixel] = to[fix->neighbors[0]] + b;
+                }
+                else
+                {
+                    to[fix->pixel] = to[fix->neighbors[2]] + a;
+                }
+                break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// 融合着色时坏点的索引在 To 循环里按坏值写出，修正 To 之后只需重写这几个像素
+void MLX90640_BadPixelPlanPalette(const badPixelPlanMLX90640 *plan, const toPaletteMLX90640 *palette, const float *to)
+{
+    for(int i = 0; i < plan->count; i++)
+    {
+        PaletteStore(palette, plan->fix[i].pixel, to[plan->fix[i].pixel]);
+    }
+}
+
+//------------------------------------------------------------------------------
+
 static void ExtractVDDParameters(uint16_t *eeData, paramsMLX90640 *mlx90640)
 {
     int8_t kVdd;
@@ -1454,3 +2086,18 @@ static int IsPixelBad(uint16_t pixel,paramsMLX90640 *params)
 }     
 
 //------------------------------------------------------------------------------
+
+static int IsPixelInPlan(uint16_t pixel, const badPixelPlanMLX90640 *plan)
+{
+    for(int i=0; i<plan->count; i++)
+    {
+        if(pixel == plan->fix[i].pixel)
+        {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+//------------------------------------------------------------------------------
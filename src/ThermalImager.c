@@ -13,6 +13,19 @@
 #include "include/driver_st7789_basic.h"
 #include "include/MLX90640_I2C_Driver.h"
 #include "include/color_lut.h"
+#include "include/diagnostics.h"
+#include "include/thermal_memory.h"
+#include "include/spsc_ring.h"
+#include "include/dual_core.h"
+#include "include/pixel_detector.h"
+#include "include/temporal_filter.h"
+#include "include/deinterlace.h"
+#include "include/upscale.h"
+#include "include/palette.h"
+#include "include/recorder.h"
+#include "include/frame_codec.h"
+#include "include/stream.h"
+#include "include/roi.h"
 
 #include "pico/multicore.h"
 
@@ -26,64 +39,320 @@
 
 #include "pico/async_context_freertos.h"
 
+// 隔行模式下按行只读当前子页的像素，每个子页 I2C 流量约减半
+#ifndef THERMAL_INTERLEAVED_READ
+#define THERMAL_INTERLEAVED_READ 0
+#endif
+
+// 坏点修正取的邻点必须与读出模式一致：隔行模式下对角邻点属于另一子页的行，读帧时不刷新
+#define THERMAL_CHESS_MODE (!THERMAL_INTERLEAVED_READ)
+
+// 启动时清除 flash 中记录的运行时坏点，换传感器或误判后烧录一次
+#ifndef THERMAL_PIXEL_DETECTOR_RESET
+#define THERMAL_PIXEL_DETECTOR_RESET 0
+#endif
+
+// 像素偏移补偿缓存的量化步长，Ta/Vdd 漂移超过才重算，设为 0 即每个子页重算；误差见 offsetCacheMLX90640
+#ifndef THERMAL_OFFSET_CACHE_TA_QUANTUM
+#define THERMAL_OFFSET_CACHE_TA_QUANTUM 0.05f
+#endif
+#ifndef THERMAL_OFFSET_CACHE_VDD_QUANTUM
+#define THERMAL_OFFSET_CACHE_VDD_QUANTUM 0.002f
+#endif
+
+// 增量 To 的噪声底（原始值计数），像素变化不超过它且 Ta/Vdd 未越过上面的量化步长时沿用上次 To
+#ifndef THERMAL_LAZY_TO_NOISE_FLOOR
+#define THERMAL_LAZY_TO_NOISE_FLOOR 4
+#endif
+
+// To 循环里直接写调色板索引/RGB565，坏点修正后只补写坏点，不再经过时域滤波、去隔行和单独着色
+#ifndef THERMAL_FUSED_PALETTE
+#define THERMAL_FUSED_PALETTE 0
+#endif
+
 #define MIN_TEMP 7.0f
 #define MAX_TEMP 40.0f
 #define MID_TEMP ((MIN_TEMP + MAX_TEMP) / 2.0f)
 
+// 显示温度场与帧内温度场同格式，紧凑模式下着色全程整数，不再转回浮点
+#if THERMAL_TEMP_CENTI
+#define MIN_TEMP_CENTI ((int16_t)(MIN_TEMP * TEMP_CENTI_SCALE))
+#define MAX_TEMP_CENTI ((int16_t)(MAX_TEMP * TEMP_CENTI_SCALE))
+#define display_colorize(temps, color) palette_colorize_centi(temps, MIN_TEMP_CENTI, MAX_TEMP_CENTI, color_lut2, color)
+#define display_index(temps, index) palette_index_centi(temps, MIN_TEMP_CENTI, MAX_TEMP_CENTI, index)
+#else
+#define display_colorize(temps, color) palette_colorize(temps, MIN_TEMP, MAX_TEMP, color_lut2, color)
+#define display_index(temps, index) palette_index(temps, MIN_TEMP, MAX_TEMP, index)
+#endif
+
 paramsMLX90640 params;
-uint16_t frame_buffer[96*72]={0};
+badPixelPlanMLX90640 bad_pixel_plan;
+static uint16_t *const frame_buffer = thermal_arena.frame_buffer;
+
+static spsc_ring_t frame_ring;
+
+// 双核时采集与处理/显示同在 core1，同优先级轮转；core0 只跑 To 分核的工作任务和后台任务，
+// 工作任务优先级最高，放在采集所在的核上会在分核计算期间抢占 I2C 读取
+#define ACQ_TASK_CORE 1
+#define MAIN_TASK_CORE 1
+#define SPLIT_WORKER_CORE 0
+
+typedef struct
+{
+    uint16_t *frameData;
+    const paramsMLX90640 *params;
+    const frameContextMLX90640 *context;
+    const lazyToMLX90640 *lazy;
+    const toPaletteMLX90640 *palette;
+    float *result;
+} to_job_t;
+
+#if THERMAL_DIAGNOSTICS
+// 单核/双核 CalculateTo 对比基准，结果随诊断报告打印
+#define TO_BENCH_INTERVAL 32
+static float to_bench_result[MLX90640_PIXEL_NUM];
+// 各放大核耗时与清晰度对比，结果不上屏
+#define UPSCALE_BENCH_INTERVAL 64
+static uint16_t upscale_bench_buffer[THERMAL_IMAGE_WIDTH * THERMAL_IMAGE_HEIGHT];
+static void upscale_benchmark(const thermal_temp_t *temps);
+// 原始帧编解码的压缩率和每帧周期数
+#define CODEC_BENCH_INTERVAL 64
+static uint8_t codec_bench_encoded[FRAME_CODEC_MAX_BYTES(MLX90640_FRAME_DATA_NUM)];
+static uint16_t codec_bench_decoded[MLX90640_FRAME_DATA_NUM];
+static void codec_benchmark(const uint16_t *frameData, const uint16_t *reference);
+#endif
 
-void draw_thermal_image(float *temps);
+// 默认保持原来的 RGB565 双线性放大
+#ifndef THERMAL_UPSCALE_KERNEL
+#define THERMAL_UPSCALE_KERNEL UPSCALE_BILINEAR
+#endif
+
+#if THERMAL_FUSED_PALETTE
+// 双线性放大吃 RGB565，其余放大核吃调色板索引，融合内核只写用得到的那一个
+static const toPaletteMLX90640 to_palette = {
+    MIN_TEMP, MAX_TEMP, 1,
+    THERMAL_UPSCALE_KERNEL == UPSCALE_BILINEAR ? NULL : thermal_arena.palette_index,
+    color_lut2,
+    THERMAL_UPSCALE_KERNEL == UPSCALE_BILINEAR ? thermal_arena.color : NULL,
+};
+#endif
+
+#if configSUPPORT_STATIC_ALLOCATION
+static StaticTask_t main_task_tcb;
+static StackType_t main_task_stack[MAIN_TASK_STACK_WORDS];
+static StaticTask_t acq_task_tcb;
+static StackType_t acq_task_stack[ACQ_TASK_STACK_WORDS];
+#endif
+
+void draw_thermal_image(const thermal_temp_t *temps);
+static void draw_roi_overlay(const roi_stats_t *stats, int count);
 uint16_t temp_to_iron_color(float temp);
 float normalize_temp(float temp);
 void Temp2RGB(float *temp, int size, float maxTemp, uint16_t *rgb);
-void bilinear_scale(const uint16_t *src, uint16_t *dst, int srcW, int srcH, int dstW, int dstH);
+static void to_job_work(void *arg, int first, int last)
+{
+    to_job_t *job = (to_job_t *)arg;
+    if (job->lazy != NULL)
+    {
+        MLX90640_CalculateToLazyRange(job->frameData, job->params, job->context, job->lazy, job->palette, first, last, job->result);
+    }
+    else
+    {
+        MLX90640_CalculateToPaletteRange(job->frameData, job->params, job->context, job->palette, first, last, job->result);
+    }
+}
+
+// 帧上下文由调用者准备好，这里只补上发射率和反射温度，像素范围分给两个核
+// 增量模式下 result 须保留上一帧的 To，重算与否在分核前就决定好
+void calculate_to_dual_core(uint16_t *frameData, const paramsMLX90640 *params, frameContextMLX90640 *context, float emissivity, float tr, float *result)
+{
+    to_job_t job = {frameData, params, context, NULL, NULL, result};
+
+    MLX90640_PrepareToContext(context, emissivity, tr);
+#if THERMAL_LAZY_TO
+    MLX90640_LazyToPrepare(&thermal_arena.lazy_to, frameData, context);
+    job.lazy = &thermal_arena.lazy_to;
+#endif
+#if THERMAL_FUSED_PALETTE
+    job.palette = &to_palette;
+#endif
+    dual_core_run(to_job_work, &job, MLX90640_PIXEL_NUM);
+}
+
+// 采集任务：从帧池取帧，读取两个子页后推入环形队列交给处理任务
+void acquisition_task(__unused void *pvParameters)
+{
+    time_t start_time;
+    thermal_frame_t *frame;
+    int status;
+    while (1)
+    {
+        frame = frame_pool_acquire();
+        if (frame == NULL)
+        {
+            vTaskDelay(1);
+            continue;
+        }
+
+        start_time = time_us_64();
+        MLX90640_TriggerMeasurement(0x33);
+
+#if THERMAL_INTERLEAVED_READ
+        status = MLX90640_GetSubpageData(0x33, frame->frameData);
+        if (status >= 0) status = MLX90640_GetSubpageData(0x33, frame->frameData);
+#else
+        status = MLX90640_GetFrameData(0x33, frame->frameData);
+        if (status >= 0) status = MLX90640_GetFrameData(0x33, frame->frameData);
+#endif
+        frame->acquire_us = time_us_64() - start_time;
+        frame->time_ms = time_us_64() / 1000;
+
+        // I2C 出错或辅助字/像素校验失败时整帧丢弃，0x7FFF 等坏字不进入后级
+        if (status < 0)
+        {
+            frame_pool_release(frame);
+            continue;
+        }
+
+        recorder_submit(frame);
+        stream_send_raw(frame);
+        // 入队失败时帧的引用仍归本任务，必须归还帧池，否则帧池会逐渐耗尽
+        if (!spsc_ring_push(&frame_ring, frame, portMAX_DELAY))
+        {
+            frame_pool_release(frame);
+        }
+    }
+}
+
 void main_task(__unused void *pvParameters)
 {
     time_t start_time,end_time;
     char str[100];
-    uint16_t frameData[834];
-    float temperatures[768];
+    thermal_frame_t *frame;
+    thermal_frame_t *last_frame = NULL;
+    uint16_t *frameData;
+    // 每个子页只更新一半像素，温度场原地更新，另一半自然沿用上一帧结果，不随帧拷贝
+    thermal_temp_t *temperatures = thermal_arena.temperatures;
+    thermal_temp_t *display = thermal_arena.display;
+#if THERMAL_TEMP_CENTI
+    // To 只在浮点工作区里算，再转成紧凑格式写入温度场
+    float *to = thermal_arena.to_work;
+#else
+    float *to = temperatures;
+#endif
     while (1)
     {
+        frame = spsc_ring_pop(&frame_ring, portMAX_DELAY);
+        frameData = frame->frameData;
+
         sprintf(str,"battery:%4.2fV",(adc_read() * 2.5f / 4096.0f) * 2.0f);
         st7789_basic_string(130, 0, str, strlen(str), BLACK, ST7789_FONT_12);
 
-        start_time = time_us_64();
-        MLX90640_TriggerMeasurement(0x33);
-
-        MLX90640_GetFrameData(0x33, frameData);
-        MLX90640_GetFrameData(0x33, frameData);
-        end_time = time_us_64();
-        sprintf(str, "GetFrame:%7ldus", end_time - start_time);
+        sprintf(str, "GetFrame:%7ldus", (long)frame->acquire_us);
         st7789_basic_string(130, 12, str, strlen(str), BLACK, ST7789_FONT_12);
 
-        float ambientTemp = MLX90640_GetTa(frameData, &params);
-        float vdd = MLX90640_GetVdd(frameData, &params);
+        // Vdd/Ta/增益/补偿像素每个子页只算一次，CalculateTo 和后续各级共用
+        MLX90640_PrepareFrame(frameData, &params, &frame->context);
+        MLX90640_OffsetCacheUpdate(&thermal_arena.offset_cache, &params, &frame->context);
+        float ambientTemp = frame->context.ta;
         
         start_time = time_us_64();
-        MLX90640_CalculateTo(frameData, &params, 0.95, ambientTemp-8, temperatures);
+        calculate_to_dual_core(frameData, &params, &frame->context, 0.95, ambientTemp-8, to);
         end_time = time_us_64();
         sprintf(str, "CalTemp:%8ldus", end_time - start_time);
         st7789_basic_string(130, 24, str, strlen(str), BLACK, ST7789_FONT_12);
 
+#if THERMAL_DIAGNOSTICS
+        if (frame->sequence % TO_BENCH_INTERVAL == 0)
+        {
+            time_t dual_us = end_time - start_time;
+            start_time = time_us_64();
+            MLX90640_CalculateTo(frameData, &params, 0.95, ambientTemp-8, to_bench_result);
+            end_time = time_us_64();
+            diagnostics_note_to_bench(end_time - start_time, dual_us);
+        }
+#endif
+
         start_time = time_us_64();
-        MLX90640_BadPixelsCorrection(params.brokenPixels, temperatures, 1, &params);
-        MLX90640_BadPixelsCorrection(params.outlierPixels, temperatures, 1, &params);
+#if THERMAL_TEMP_CENTI
+        // 本子页转成紧凑格式后整数修正坏点；融合着色的坏点索引仍按浮点修正值补写
+        temp_centi_update(frameData, to, temperatures);
+        temp_centi_bad_pixel_apply(&bad_pixel_plan, temperatures);
+#if THERMAL_FUSED_PALETTE
+        MLX90640_BadPixelPlanApply(&bad_pixel_plan, to);
+        MLX90640_BadPixelPlanPalette(&bad_pixel_plan, &to_palette, to);
+#endif
+#else
+        MLX90640_BadPixelPlanApply(&bad_pixel_plan, temperatures);
+#if THERMAL_FUSED_PALETTE
+        MLX90640_BadPixelPlanPalette(&bad_pixel_plan, &to_palette, temperatures);
+#endif
+#endif
         end_time = time_us_64();
+        stream_send_temperatures(frame->sequence, temperatures);
         sprintf(str, "BadPixelFix:%4ldus", end_time - start_time);
         st7789_basic_string(130, 36, str, strlen(str), BLACK, ST7789_FONT_12);
 
+        // 新发现的坏点从下一帧起进入修正表
+        start_time = time_us_64();
+        pixel_detector_update(frameData, temperatures);
+        end_time = time_us_64();
+        sprintf(str, "PixCheck:%7ldus", end_time - start_time);
+        st7789_basic_string(130, 60, str, strlen(str), BLACK, ST7789_FONT_12);
+
+        // ROI 统计用坏点修正后、滤波前的温度场，与流里的温度包一致
+        roi_stats_t roi_stats[ROI_MAX];
         start_time = time_us_64();
-        draw_thermal_image(temperatures);
+        roi_update(temperatures);
+        int roi_count = roi_get_stats(roi_stats);
+        end_time = time_us_64();
+        stream_send_roi(frame->sequence, roi_stats, roi_count);
+        sprintf(str, "ROI:%12ldus", end_time - start_time);
+        st7789_basic_string(130, 84, str, strlen(str), BLACK, ST7789_FONT_12);
+
+#if THERMAL_FUSED_PALETTE
+        // 着色已在 To 循环里完成，显示的就是未滤波的温度场
+        display = temperatures;
+#else
+        // 滤波结果单独存放，帧内温度保持未滤波值供下一帧沿用和坏点检测
+        // 计时包含时域滤波和子页去隔行
+        start_time = time_us_64();
+        temporal_filter_apply(frameData, temperatures, display);
+        deinterlace_apply(frameData, temperatures, display);
+        end_time = time_us_64();
+        sprintf(str, "Filter:%9ldus", end_time - start_time);
+        st7789_basic_string(130, 72, str, strlen(str), BLACK, ST7789_FONT_12);
+#endif
+
+        start_time = time_us_64();
+        draw_thermal_image(display);
         end_time = time_us_64();
         sprintf(str, "DrawImage:%6ldus", end_time - start_time);
         st7789_basic_string(130, 48, str, strlen(str), BLACK, ST7789_FONT_12);
 
+#if THERMAL_DIAGNOSTICS
+        if (frame->sequence % UPSCALE_BENCH_INTERVAL == 0)
+        {
+            upscale_benchmark(display);
+        }
+        if (frame->sequence % CODEC_BENCH_INTERVAL == 1 && last_frame != NULL)
+        {
+            codec_benchmark(frameData, last_frame->frameData);
+        }
+#endif
+
         sprintf(str, "AmbientTemp:%4.1f", ambientTemp);
         st7789_basic_string(0, 72, str, strlen(str), ORANGE, ST7789_FONT_12);
-        sprintf(str, "CentreTemp:%5.1f", temperatures[768/2]);
-        st7789_basic_string(0, 84, str, strlen(str), ORANGE, ST7789_FONT_12);
+        draw_roi_overlay(roi_stats, roi_count);
+
+        if (last_frame != NULL)
+        {
+            frame_pool_release(last_frame);
+        }
+        last_frame = frame;
+
+        // 新坏点的 flash 记录在帧末尾写入，不打断本帧的处理和显示
+        pixel_detector_flush();
     }
 }
 
@@ -118,19 +387,38 @@ int main()
     st7789_basic_clear();
     st7789_basic_display_on();
 
-    uint16_t *eeData = (uint16_t *)malloc(832);
+    uint16_t *eeData = thermal_arena.eeData;
     if(MLX90640_DumpEE(0x33, eeData) != 0) {
         st7789_basic_string(0,0,"EEPROM Read Error!",19,RED,ST7789_FONT_12);
-        free(eeData);
         return 0;
     }
     
     if(MLX90640_ExtractParameters(eeData, &params) != 0) {
         st7789_basic_string(0,0,"Params Read Error!",19,RED,ST7789_FONT_12);
-        free(eeData);
         return 0;
     }
-    free(eeData);
+
+    // 坏点修正表只生成一次，每帧按表直接取邻点
+    MLX90640_BadPixelPlanInit(&bad_pixel_plan);
+    MLX90640_BadPixelPlanAddList(&bad_pixel_plan, params.brokenPixels, THERMAL_CHESS_MODE, &params);
+    MLX90640_BadPixelPlanAddList(&bad_pixel_plan, params.outlierPixels, THERMAL_CHESS_MODE, &params);
+    pixel_detector_init(&bad_pixel_plan, &params, THERMAL_CHESS_MODE);
+#if THERMAL_PIXEL_DETECTOR_RESET
+    pixel_detector_reset();
+#endif
+
+    temporal_filter_config_t filter_config = TEMPORAL_FILTER_DEFAULT_CONFIG;
+    temporal_filter_init(&filter_config);
+    MLX90640_OffsetCacheInit(&thermal_arena.offset_cache, THERMAL_OFFSET_CACHE_TA_QUANTUM, THERMAL_OFFSET_CACHE_VDD_QUANTUM);
+#if THERMAL_LAZY_TO
+    MLX90640_LazyToInit(&thermal_arena.lazy_to, THERMAL_LAZY_TO_NOISE_FLOOR, THERMAL_OFFSET_CACHE_TA_QUANTUM, THERMAL_OFFSET_CACHE_VDD_QUANTUM);
+#endif
+    deinterlace_init(DEINTERLACE_MOTION_LIMIT);
+    // 默认 ROI：全画面的最高/最低温，以及代替原来中心温度的中心 3x3 点
+    roi_init();
+    roi_add_rect(0, 0, 31, 23);
+    roi_add_spot(16, 12, 1);
+    upscale_init();
     st7789_basic_clear();
     char str[100];
     sprintf(str, "%5.1f", MIN_TEMP);
@@ -148,33 +436,146 @@ int main()
     }
     st7789_basic_draw_picture_16bits(118, 0, 127, 71, frame_buffer);
 
+#if THERMAL_INTERLEAVED_READ
+    MLX90640_SetInterleavedMode(0x33); // 隔行模式，每个子页只读一半行
+#else
     MLX90640_SetChessMode(0x33);      // 使用棋盘模式
+#endif
     MLX90640_SetRefreshRate(0x33, 4); // 8Hz刷新率
     MLX90640_SetResolution(0x33, 3);  // 19位分辨率
-
-    xTaskCreate(main_task, "mainThread", 1024 * 2, NULL, 1, NULL);
+    recorder_init(eeData, 4, 3, THERMAL_CHESS_MODE);
+
+    frame_pool_init(thermal_arena.frames, FRAME_POOL_SIZE);
+    spsc_ring_init(&frame_ring, SPSC_RING_DROP_NEWEST);
+    dual_core_init(SPLIT_WORKER_CORE);
+    diagnostics_watch_ring(&frame_ring);
+    thermal_memory_report();
+
+    TaskHandle_t main_handle;
+    TaskHandle_t acq_handle;
+#if configSUPPORT_STATIC_ALLOCATION
+    main_handle = xTaskCreateStatic(main_task, "mainThread", MAIN_TASK_STACK_WORDS, NULL, 1, main_task_stack, &main_task_tcb);
+    acq_handle = xTaskCreateStatic(acquisition_task, "acqThread", ACQ_TASK_STACK_WORDS, NULL, 1, acq_task_stack, &acq_task_tcb);
+#else
+    xTaskCreate(main_task, "mainThread", MAIN_TASK_STACK_WORDS, NULL, 1, &main_handle);
+    xTaskCreate(acquisition_task, "acqThread", ACQ_TASK_STACK_WORDS, NULL, 1, &acq_handle);
+#endif
+#if configNUMBER_OF_CORES > 1
+    vTaskCoreAffinitySet(main_handle, 1 << MAIN_TASK_CORE);
+    vTaskCoreAffinitySet(acq_handle, 1 << ACQ_TASK_CORE);
+#else
+    (void)main_handle;
+    (void)acq_handle;
+#endif
+    diagnostics_start();
+    recorder_start();
+    stream_init();
     vTaskStartScheduler();
     while(1);
     return 0;
 }
 
-void draw_thermal_image(float *temps)
+void draw_thermal_image(const thermal_temp_t *temps)
+{
+    if (THERMAL_UPSCALE_KERNEL == UPSCALE_BILINEAR)
+    {
+        uint16_t *color = thermal_arena.color;
+#if !THERMAL_FUSED_PALETTE
+        display_colorize(temps, color);
+#endif
+        bilinear_scale(color, frame_buffer, 32, 24, 96, 72);
+    }
+    else
+    {
+        // 在调色板索引上插值再查表，避免 RGB565 分量插值产生调色板外的颜色
+        uint8_t *index = thermal_arena.palette_index;
+#if !THERMAL_FUSED_PALETTE
+        display_index(temps, index);
+#endif
+        upscale_to_rgb565(THERMAL_UPSCALE_KERNEL, index, color_lut2, thermal_arena.upscale_rows, frame_buffer);
+    }
+
+    st7789_basic_draw_picture_16bits(0, 0, 95, 71, frame_buffer);
+}
+
+// 在热图上标出 ROI 0 的最高/最低温位置，每个 ROI 一行 最低/均值/最高 和标准差
+static void draw_roi_marker(uint16_t pixel, uint32_t color)
+{
+    // 显示按列镜像，每个传感器像素放大成 3x3；st7789_fill_rect 要求 left < right、top < bottom，线宽取 2
+    int x = (31 - (pixel & 31)) * 3 + 1;
+    int y = (pixel >> 5) * 3 + 1;
+    st7789_basic_rect(x > 2 ? x - 2 : 0, y, x < 93 ? x + 2 : 95, y + 1, color);
+    st7789_basic_rect(x, y > 2 ? y - 2 : 0, x + 1, y < 69 ? y + 2 : 71, color);
+}
+
+static void draw_roi_overlay(const roi_stats_t *stats, int count)
+{
+    char str[48];
+
+    if (count > 0 && stats[0].count > 0)
+    {
+        draw_roi_marker(stats[0].max_pixel, WHITE);
+        draw_roi_marker(stats[0].min_pixel, BLACK);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (stats[i].count == 0) continue;
+        sprintf(str, "R%d %5.1f/%5.1f/%5.1f sd%4.2f", i, stats[i].min / 100.0f, stats[i].mean / 100.0f,
+                stats[i].max / 100.0f, stats[i].stddev / 100.0f);
+        st7789_basic_string(0, 96 + 12 * i, str, strlen(str), ORANGE, ST7789_FONT_12);
+    }
+}
+
+#if THERMAL_DIAGNOSTICS
+// 用刚显示的一帧对比所有放大核，融合着色时重新着色的结果与 To 循环写出的相同
+static void upscale_benchmark(const thermal_temp_t *temps)
 {
-    uint16_t color[32 * 24];
-    for (int i = 0; i < 24; i++)
+    static const char *const names[UPSCALE_KERNEL_NUM] = {"bilinear", "bicubic", "edge", "lanczos2"};
+    uint8_t *index = thermal_arena.palette_index;
+    uint16_t *color = thermal_arena.color;
+
+    display_index(temps, index);
+    display_colorize(temps, color);
+
+    for (int k = 0; k < UPSCALE_KERNEL_NUM; k++)
     {
-        for (int j = 0; j < 32; j++)
+        uint64_t start_time = time_us_64();
+        if (k == UPSCALE_BILINEAR)
         {
-            float temp = temps[32 * i + j];
-            color[i * 32 + 31 - j] = temp_to_iron_color(temp);
+            bilinear_scale(color, upscale_bench_buffer, 32, 24, 96, 72);
         }
-        
+        else
+        {
+            upscale_to_rgb565(k, index, color_lut2, thermal_arena.upscale_rows, upscale_bench_buffer);
+        }
+        uint64_t end_time = time_us_64();
+        printf("bench: upscale %-8s %5ldus sharpness %lu\n", names[k],
+               (long)(end_time - start_time), (unsigned long)upscale_sharpness(upscale_bench_buffer));
     }
+}
 
-    bilinear_scale(color, frame_buffer, 32, 24, 96, 72);
+// 以上一子页为参考，对当前帧跑一遍所有编码模式并校验解码结果
+static void codec_benchmark(const uint16_t *frameData, const uint16_t *reference)
+{
+    static const char *const names[FRAME_CODEC_MODE_NUM] = {"raw", "spatial", "temporal", "rice-spat", "rice-temp"};
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
 
-    st7789_basic_draw_picture_16bits(0, 0, 95, 71, frame_buffer);
+    for (int m = 0; m < FRAME_CODEC_MODE_NUM; m++)
+    {
+        uint64_t start_time = time_us_64();
+        int size = frame_codec_encode(m, frameData, reference, MLX90640_FRAME_DATA_NUM, codec_bench_encoded);
+        uint64_t encode_us = time_us_64() - start_time;
+        start_time = time_us_64();
+        int used = frame_codec_decode(m, codec_bench_encoded, size, reference, MLX90640_FRAME_DATA_NUM, codec_bench_decoded);
+        uint64_t decode_us = time_us_64() - start_time;
+        bool match = used == size && memcmp(codec_bench_decoded, frameData, sizeof(codec_bench_decoded)) == 0;
+
+        printf("bench: codec %-9s %4d bytes ratio %.2f encode %lu cycles decode %lu cycles%s\n", names[m], size,
+               (float)(MLX90640_FRAME_DATA_NUM * 2) / (float)size, (unsigned long)(encode_us * mhz),
+               (unsigned long)(decode_us * mhz), match ? "" : " MISMATCH");
+    }
 }
+#endif
 
 uint16_t temp_to_iron_color(float temp)
 {
@@ -225,64 +626,4 @@ void Temp2RGB(float* temp,int size,float maxTemp,uint16_t* rgb)
 		rgb[i] = (rbits<<11)|(gbits<<5)|bbits;
 	}
 	
-}
-
-void bilinear_scale(const uint16_t *src, uint16_t *dst, int srcW, int srcH, int dstW, int dstH) {
-    float scaleX = (float)(srcW - 1) / (dstW - 1);
-    float scaleY = (float)(srcH - 1) / (dstH - 1);
-
-    for (int y = 0; y < dstH; y++) {
-        for (int x = 0; x < dstW; x++) {
-            float srcX = x * scaleX;
-            float srcY = y * scaleY;
-
-            int x1 = (int)srcX;
-            int y1 = (int)srcY;
-            int x2 = (x1 + 1 >= srcW) ? srcW - 1 : x1 + 1;
-            int y2 = (y1 + 1 >= srcH) ? srcH - 1 : y1 + 1;
-
-            float dx = srcX - x1;
-            float dy = srcY - y1;
-
-            uint16_t Q11 = src[y1 * srcW + x1];
-            uint16_t Q21 = src[y1 * srcW + x2];
-            uint16_t Q12 = src[y2 * srcW + x1];
-            uint16_t Q22 = src[y2 * srcW + x2];
-
-            // 提取 RGB565 分量
-            float r1 = (Q11 >> 11) & 0x1F;
-            float g1 = (Q11 >> 5)  & 0x3F;
-            float b1 = Q11         & 0x1F;
-
-            float r2 = (Q21 >> 11) & 0x1F;
-            float g2 = (Q21 >> 5)  & 0x3F;
-            float b2 = Q21         & 0x1F;
-
-            float r3 = (Q12 >> 11) & 0x1F;
-            float g3 = (Q12 >> 5)  & 0x3F;
-            float b3 = Q12         & 0x1F;
-
-            float r4 = (Q22 >> 11) & 0x1F;
-            float g4 = (Q22 >> 5)  & 0x3F;
-            float b4 = Q22         & 0x1F;
-
-            // 水平插值（上方）
-            float topR = (1 - dx) * r1 + dx * r2;
-            float topG = (1 - dx) * g1 + dx * g2;
-            float topB = (1 - dx) * b1 + dx * b2;
-
-            // 水平插值（下方）
-            float bottomR = (1 - dx) * r3 + dx * r4;
-            float bottomG = (1 - dx) * g3 + dx * g4;
-            float bottomB = (1 - dx) * b3 + dx * b4;
-
-            // 垂直插值
-            float R = (1 - dy) * topR + dy * bottomR;
-            float G = (1 - dy) * topG + dy * bottomG;
-            float B = (1 - dy) * topB + dy * bottomB;
-
-            // 合并成 RGB565
-            dst[y * dstW + x] = ((uint16_t)(R) << 11) | ((uint16_t)(G) << 5) | (uint16_t)(B);
-        }
-    }
 }
\ No newline at end of file
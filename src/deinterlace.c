@@ -0,0 +1,96 @@
+#include <math.h>
+#include <string.h>
+#include "include/deinterlace.h"
+
+#define NEIGHBOR_UP 0x01
+#define NEIGHBOR_DOWN 0x02
+#define NEIGHBOR_LEFT 0x04
+#define NEIGHBOR_RIGHT 0x08
+#define NEIGHBOR_CHESS(mask) ((mask) & 0x0F)
+#define NEIGHBOR_INTERLEAVED(mask) ((mask) >> 4)
+
+// 每像素另一子页邻点的方向掩码：低 4 位棋盘模式，高 4 位隔行模式
+static uint8_t neighbor_mask[MLX90640_PIXEL_NUM];
+static const int16_t neighbor_offset[4] = {-MLX90640_LINE_SIZE, MLX90640_LINE_SIZE, -1, 1};
+static const float neighbor_scale[5] = {0.0f, 1.0f, 1.0f / 2, 1.0f / 3, 1.0f / 4};
+// 各像素上次刷新时的温度，温度场原地更新后靠它求帧间变化
+static thermal_temp_t last_to[MLX90640_PIXEL_NUM];
+static uint8_t last_primed;
+static float deinterlace_limit;
+static deinterlace_stats_t deinterlace_stats;
+
+void deinterlace_init(float motion_limit)
+{
+    deinterlace_limit = motion_limit;
+    last_primed = 0;
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        int line = pixel / MLX90640_LINE_SIZE;
+        int column = pixel % MLX90640_LINE_SIZE;
+        uint8_t vertical = 0;
+        uint8_t horizontal = 0;
+
+        if (line > 0) vertical |= NEIGHBOR_UP;
+        if (line < MLX90640_LINE_NUM - 1) vertical |= NEIGHBOR_DOWN;
+        if (column > 0) horizontal |= NEIGHBOR_LEFT;
+        if (column < MLX90640_COLUMN_NUM - 1) horizontal |= NEIGHBOR_RIGHT;
+
+        neighbor_mask[pixel] = (vertical | horizontal) | (vertical << 4);
+    }
+}
+
+// to 为本帧未滤波的温度场，result 为待显示的温度场（原地修改）
+// 只写本子页未更新的像素，读的邻点都是新像素，因此可以原地处理
+void deinterlace_apply(uint16_t *frameData, const thermal_temp_t *to, thermal_temp_t *result)
+{
+    int chess = MLX90640_IS_CHESS_MODE(frameData);
+    int subPage = frameData[833];
+
+    // 第一帧没有上次的值，只记录
+    if (!last_primed)
+    {
+        memcpy(last_to, to, sizeof(last_to));
+        last_primed = 1;
+        return;
+    }
+
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        if (MLX90640_PIXEL_PATTERN(pixel, chess) == subPage) continue;
+
+        uint8_t mask = chess ? NEIGHBOR_CHESS(neighbor_mask[pixel]) : NEIGHBOR_INTERLEAVED(neighbor_mask[pixel]);
+        float fresh = 0.0f;
+        float motion = 0.0f;
+        int count = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (mask & (1 << i))
+            {
+                int neighbor = pixel + neighbor_offset[i];
+                fresh += result[neighbor];
+                // 取绝对值：边缘经过时一侧升温一侧降温，带符号求和会互相抵消
+                motion += fabsf(THERMAL_TEMP_FLOAT(to[neighbor] - last_to[neighbor]));
+                count++;
+            }
+        }
+
+        if (motion * neighbor_scale[count] > deinterlace_limit)
+        {
+            result[pixel] = (thermal_temp_t)(fresh * neighbor_scale[count]);
+            deinterlace_stats.replaced++;
+        }
+    }
+
+    // 邻点都用完后再更新本子页的记录
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        if (MLX90640_PIXEL_PATTERN(pixel, chess) == subPage) last_to[pixel] = to[pixel];
+    }
+    deinterlace_stats.frames++;
+}
+
+void deinterlace_get_stats(deinterlace_stats_t *stats)
+{
+    *stats = deinterlace_stats;
+}
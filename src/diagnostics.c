@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "include/diagnostics.h"
+#include "include/thermal_memory.h"
+#include "include/pixel_detector.h"
+#include "include/deinterlace.h"
+#include "include/recorder.h"
+#include "include/stream.h"
+#include "include/MLX90640_API.h"
+
+#if THERMAL_DIAGNOSTICS
+
+static const spsc_ring_t *watched_ring;
+static uint32_t to_bench_single_us;
+static uint32_t to_bench_dual_us;
+static TaskStatus_t task_status[DIAGNOSTICS_MAX_TASKS];
+
+#if configSUPPORT_STATIC_ALLOCATION
+static StaticTask_t diagnostics_task_tcb;
+static StackType_t diagnostics_task_stack[DIAG_TASK_STACK_WORDS];
+#endif
+
+// 运行时间统计使用 1us 分辨率的 64 位硬件定时器，不会溢出
+uint64_t diagnostics_run_time_counter(void)
+{
+    return time_us_64();
+}
+
+void diagnostics_report(void)
+{
+    configRUN_TIME_COUNTER_TYPE total_time;
+    UBaseType_t count;
+
+    count = uxTaskGetSystemState(task_status, DIAGNOSTICS_MAX_TASKS, &total_time);
+    if (count == 0) {
+        printf("diag: more than %d tasks, increase DIAGNOSTICS_MAX_TASKS\n", DIAGNOSTICS_MAX_TASKS);
+        return;
+    }
+    if (total_time == 0) total_time = 1;
+
+    printf("diag: %-12s %10s %6s %8s\n", "task", "time(us)", "cpu%", "stack(w)");
+    for (UBaseType_t i = 0; i < count; i++) {
+        printf("diag: %-12s %10llu %5.1f%% %8lu\n",
+               task_status[i].pcTaskName,
+               (unsigned long long)task_status[i].ulRunTimeCounter,
+               100.0f * (float)task_status[i].ulRunTimeCounter / (float)total_time,
+               (unsigned long)task_status[i].usStackHighWaterMark);
+    }
+    printf("diag: heap free %u, min ever free %u of %u bytes\n",
+           (unsigned)xPortGetFreeHeapSize(),
+           (unsigned)xPortGetMinimumEverFreeHeapSize(),
+           (unsigned)configTOTAL_HEAP_SIZE);
+
+    frame_pool_stats_t pool;
+    frame_pool_get_stats(&pool);
+    printf("diag: frame pool acquired %lu released %lu exhausted %lu in use %u (max %u of %d)\n",
+           (unsigned long)pool.acquired, (unsigned long)pool.released, (unsigned long)pool.exhausted,
+           pool.in_use, pool.in_use_max, FRAME_POOL_SIZE);
+
+    pixel_detector_stats_t detector;
+    pixel_detector_get_stats(&detector);
+    printf("diag: pixel detector frames %lu found %u last %luus max %luus flash writes %lu failures %lu%s\n",
+           (unsigned long)detector.frames, detector.found,
+           (unsigned long)detector.last_us, (unsigned long)detector.max_us,
+           (unsigned long)detector.flash_writes, (unsigned long)detector.flash_failures,
+           detector.dirty ? " pending" : "");
+
+    deinterlace_stats_t deinterlace;
+    deinterlace_get_stats(&deinterlace);
+    printf("diag: deinterlace frames %lu replaced pixels %lu\n",
+           (unsigned long)deinterlace.frames, (unsigned long)deinterlace.replaced);
+
+    transferStatsMLX90640 transfer;
+    MLX90640_GetTransferStats(&transfer);
+    printf("diag: i2c subpages %lu transactions %lu polls %lu last subpage %u transactions %u polls\n",
+           (unsigned long)transfer.frames, (unsigned long)transfer.transactions, (unsigned long)transfer.statusPolls,
+           transfer.lastTransactions, transfer.lastStatusPolls);
+
+    const offsetCacheMLX90640 *offset_cache = &thermal_arena.offset_cache;
+    uint32_t lookups = offset_cache->hits + offset_cache->misses;
+    printf("diag: offset cache hits %lu misses %lu hit rate %.1f%% (Ta %.3f Vdd %.4f)\n",
+           (unsigned long)offset_cache->hits, (unsigned long)offset_cache->misses,
+           lookups ? 100.0f * (float)offset_cache->hits / (float)lookups : 0.0f,
+           offset_cache->ta, offset_cache->vdd);
+
+#if THERMAL_LAZY_TO
+    const lazyToMLX90640 *lazy_to = &thermal_arena.lazy_to;
+    uint32_t pixels = lazy_to->computed + lazy_to->skipped;
+    printf("diag: lazy To computed %lu skipped %lu (%.1f%%) refreshes %lu\n",
+           (unsigned long)lazy_to->computed, (unsigned long)lazy_to->skipped,
+           pixels ? 100.0f * (float)lazy_to->skipped / (float)pixels : 0.0f,
+           (unsigned long)lazy_to->refreshes);
+#endif
+
+#if THERMAL_RECORDER
+    recorder_stats_t recorder;
+    recorder_get_stats(&recorder);
+    printf("diag: recorder session %lu frames %lu dropped %lu sectors %lu of %d ratio %.2f write max %luus%s\n",
+           (unsigned long)recorder.session, (unsigned long)recorder.frames, (unsigned long)recorder.dropped,
+           (unsigned long)recorder.sectors, RECORDER_SECTOR_NUM,
+           recorder.encoded_bytes ? (float)recorder.raw_bytes / (float)recorder.encoded_bytes : 0.0f,
+           (unsigned long)recorder.write_us_max, recorder.full ? " full" : "");
+#endif
+
+#if THERMAL_STREAM
+    stream_stats_t stream;
+    stream_get_stats(&stream);
+    printf("diag: stream packets %lu bytes %lu dropped %lu disconnected %lu\n",
+           (unsigned long)stream.packets, (unsigned long)stream.bytes,
+           (unsigned long)stream.dropped, (unsigned long)stream.disconnected);
+#endif
+
+    if (to_bench_single_us != 0)
+    {
+        printf("diag: CalculateTo single %luus dual %luus speedup %.2fx\n",
+               (unsigned long)to_bench_single_us, (unsigned long)to_bench_dual_us,
+               (float)to_bench_single_us / (float)(to_bench_dual_us ? to_bench_dual_us : 1));
+    }
+
+    if (watched_ring != NULL)
+    {
+        const spsc_ring_stats_t *ring = &watched_ring->stats;
+        printf("diag: frame ring pushed %lu popped %lu overruns %lu waits %lu/%lu depth max %lu of %d\n",
+               (unsigned long)ring->pushed, (unsigned long)ring->popped, (unsigned long)ring->overruns,
+               (unsigned long)ring->producer_waits, (unsigned long)ring->consumer_waits,
+               (unsigned long)ring->depth_max, SPSC_RING_CAPACITY);
+    }
+}
+
+void diagnostics_watch_ring(const spsc_ring_t *ring)
+{
+    watched_ring = ring;
+}
+
+void diagnostics_note_to_bench(uint32_t single_us, uint32_t dual_us)
+{
+    to_bench_single_us = single_us;
+    to_bench_dual_us = dual_us;
+}
+
+static void diagnostics_task(__unused void *pvParameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DIAGNOSTICS_REPORT_PERIOD_MS));
+        diagnostics_report();
+    }
+}
+
+void diagnostics_start(void)
+{
+#if configSUPPORT_STATIC_ALLOCATION
+    xTaskCreateStatic(diagnostics_task, "diagThread", DIAG_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1,
+                      diagnostics_task_stack, &diagnostics_task_tcb);
+#else
+    xTaskCreate(diagnostics_task, "diagThread", DIAG_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1, NULL);
+#endif
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+    (void)xTask;
+    panic("diag: stack overflow in task %s\n", pcTaskName);
+}
+
+void vApplicationMallocFailedHook(void)
+{
+    panic("diag: pvPortMalloc failed, heap free %u\n", (unsigned)xPortGetFreeHeapSize());
+}
+
+#else
+
+uint64_t diagnostics_run_time_counter(void)
+{
+    return 0;
+}
+
+void diagnostics_report(void)
+{
+}
+
+void diagnostics_watch_ring(const spsc_ring_t *ring)
+{
+    (void)ring;
+}
+
+void diagnostics_note_to_bench(uint32_t single_us, uint32_t dual_us)
+{
+    (void)single_us;
+    (void)dual_us;
+}
+
+void diagnostics_start(void)
+{
+}
+
+#endif
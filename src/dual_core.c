@@ -0,0 +1,79 @@
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "include/dual_core.h"
+
+#if configNUMBER_OF_CORES > 1
+
+typedef struct
+{
+    dual_core_work_t work;
+    void *arg;
+    int first;
+    int last;
+} dual_core_job_t;
+
+static dual_core_job_t job;
+static TaskHandle_t worker_handle;
+// 汇合用独立的信号量，避免和调用者自身的任务通知（如帧队列唤醒）混在一起
+static SemaphoreHandle_t join_done;
+
+#if configSUPPORT_STATIC_ALLOCATION
+static StaticSemaphore_t join_done_buffer;
+static StaticTask_t worker_tcb;
+static StackType_t worker_stack[DUAL_CORE_WORKER_STACK_WORDS];
+#endif
+
+static void dual_core_worker(__unused void *pvParameters)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        job.work(job.arg, job.first, job.last);
+        xSemaphoreGive(join_done);
+    }
+}
+
+void dual_core_init(int worker_core)
+{
+#if configSUPPORT_STATIC_ALLOCATION
+    join_done = xSemaphoreCreateBinaryStatic(&join_done_buffer);
+    worker_handle = xTaskCreateStatic(dual_core_worker, "splitWorker", DUAL_CORE_WORKER_STACK_WORDS, NULL,
+                                      DUAL_CORE_WORKER_PRIORITY, worker_stack, &worker_tcb);
+#else
+    join_done = xSemaphoreCreateBinary();
+    xTaskCreate(dual_core_worker, "splitWorker", DUAL_CORE_WORKER_STACK_WORDS, NULL,
+                DUAL_CORE_WORKER_PRIORITY, &worker_handle);
+#endif
+    vTaskCoreAffinitySet(worker_handle, 1 << worker_core);
+}
+
+void dual_core_run(dual_core_work_t work, void *arg, int count)
+{
+    int split = count / 2;
+
+    job.work = work;
+    job.arg = arg;
+    job.first = split;
+    job.last = count;
+    xTaskNotifyGive(worker_handle);
+
+    work(arg, 0, split);
+
+    xSemaphoreTake(join_done, portMAX_DELAY);
+}
+
+#else
+
+void dual_core_init(int worker_core)
+{
+    (void)worker_core;
+}
+
+void dual_core_run(dual_core_work_t work, void *arg, int count)
+{
+    work(arg, 0, count);
+}
+
+#endif
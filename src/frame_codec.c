@@ -0,0 +1,272 @@
+#include <string.h>
+#include "include/frame_codec.h"
+
+// 块头：0~16 为位打包位宽，RICE_BLOCK | k 为 Rice 参数 k
+#define RICE_BLOCK 0x80
+#define RICE_K_MAX 15
+// 商达到该值时转义为 16 位原值
+#define RICE_ESCAPE 16
+
+// 像素区 32x24，其后为辅助数据
+#define CODEC_PIXEL_WIDTH 32
+#define CODEC_PIXEL_NUM 768
+
+typedef struct
+{
+    uint8_t *p;
+    uint32_t bits;
+    int used;
+} bit_writer_t;
+
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    uint32_t bits;
+    int used;
+} bit_reader_t;
+
+static inline uint16_t zigzag(uint16_t residual)
+{
+    int16_t r = (int16_t)residual;
+    // 左移在无符号数上做，负数左移是未定义行为
+    return (uint16_t)(((uint16_t)r << 1) ^ (uint16_t)(r >> 15));
+}
+
+static inline uint16_t unzigzag(uint16_t value)
+{
+    return (uint16_t)((value >> 1) ^ -(value & 1));
+}
+
+static inline int16_t median3(int16_t a, int16_t b, int16_t c)
+{
+    if (a > b) { int16_t t = a; a = b; b = t; }
+    return c < a ? a : (c > b ? b : c);
+}
+
+// 预测只用已编码（解码）过的字，编解码两端结果一致
+static inline uint16_t predict(frame_codec_mode_t mode, const uint16_t *words, const uint16_t *reference, int i)
+{
+    int column = i & (CODEC_PIXEL_WIDTH - 1);
+
+    switch (mode)
+    {
+        case FRAME_CODEC_TEMPORAL:
+            return reference[i];
+        case FRAME_CODEC_RICE_TEMPORAL:
+            // i-2 与 i 在棋盘和隔行模式下都属于同一子页
+            if (i < CODEC_PIXEL_NUM && column >= 2) return reference[i] + (uint16_t)(words[i - 2] - reference[i - 2]);
+            return reference[i];
+        case FRAME_CODEC_RICE_SPATIAL:
+            // LOCO-I 的 MED 预测，第一行/第一列退化为左邻/上邻
+            if (i < CODEC_PIXEL_NUM && i >= CODEC_PIXEL_WIDTH)
+            {
+                int16_t up = words[i - CODEC_PIXEL_WIDTH];
+                if (column == 0) return up;
+                int16_t left = words[i - 1];
+                int16_t corner = words[i - CODEC_PIXEL_WIDTH - 1];
+                return median3(left, up, (int16_t)(left + up - corner));
+            }
+            return i > 0 ? words[i - 1] : 0;
+        default:
+            return i > 0 ? words[i - 1] : 0;
+    }
+}
+
+static inline void put_bits(bit_writer_t *w, uint32_t value, int n)
+{
+    w->bits |= value << w->used;
+    w->used += n;
+    while (w->used >= 8)
+    {
+        *w->p++ = w->bits & 0xFF;
+        w->bits >>= 8;
+        w->used -= 8;
+    }
+}
+
+static inline void flush_bits(bit_writer_t *w)
+{
+    if (w->used > 0) *w->p++ = w->bits & 0xFF;
+    w->bits = 0;
+    w->used = 0;
+}
+
+static inline int fill_bits(bit_reader_t *r, int n)
+{
+    while (r->used < n)
+    {
+        if (r->p >= r->end) return -1;
+        r->bits |= (uint32_t)*r->p++ << r->used;
+        r->used += 8;
+    }
+    return 0;
+}
+
+static inline uint32_t take_bits(bit_reader_t *r, int n)
+{
+    uint32_t value = r->bits & ((1u << n) - 1);
+    r->bits >>= n;
+    r->used -= n;
+    return value;
+}
+
+static inline int rice_bits(uint16_t value, int k)
+{
+    int q = value >> k;
+    return q < RICE_ESCAPE ? q + 1 + k : RICE_ESCAPE + 16;
+}
+
+// 按块均值估计 k，再在相邻两个 k 中取编码最短的
+static int rice_choose(const uint16_t *residual, int n, uint32_t sum, int *bits)
+{
+    int estimate = 0;
+    int best_k = 0;
+    int best_bits = 0x7FFFFFFF;
+
+    while (estimate < RICE_K_MAX && ((uint32_t)n << (estimate + 1)) <= sum) estimate++;
+    for (int k = estimate > 0 ? estimate - 1 : 0; k <= estimate + 1 && k <= RICE_K_MAX; k++)
+    {
+        int total = 0;
+        for (int i = 0; i < n; i++) total += rice_bits(residual[i], k);
+        if (total < best_bits)
+        {
+            best_bits = total;
+            best_k = k;
+        }
+    }
+    *bits = best_bits;
+    return best_k;
+}
+
+static inline int is_rice(frame_codec_mode_t mode)
+{
+    return mode == FRAME_CODEC_RICE_SPATIAL || mode == FRAME_CODEC_RICE_TEMPORAL;
+}
+
+// 返回编码后的字节数，最多 FRAME_CODEC_MAX_BYTES(count)
+int frame_codec_encode(frame_codec_mode_t mode, const uint16_t *words, const uint16_t *reference, int count, uint8_t *out)
+{
+    bit_writer_t w = {out, 0, 0};
+
+    if (mode == FRAME_CODEC_RAW)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            *w.p++ = words[i] & 0xFF;
+            *w.p++ = words[i] >> 8;
+        }
+        return w.p - out;
+    }
+
+    for (int block = 0; block < count; block += FRAME_CODEC_BLOCK)
+    {
+        uint16_t residual[FRAME_CODEC_BLOCK];
+        int n = count - block < FRAME_CODEC_BLOCK ? count - block : FRAME_CODEC_BLOCK;
+        uint16_t any = 0;
+        uint32_t sum = 0;
+        int width = 0;
+
+        for (int i = 0; i < n; i++)
+        {
+            residual[i] = zigzag(words[block + i] - predict(mode, words, reference, block + i));
+            any |= residual[i];
+            sum += residual[i];
+        }
+        while (any >> width) width++;
+
+        int rice_total = 0;
+        int k = is_rice(mode) ? rice_choose(residual, n, sum, &rice_total) : 0;
+        if (is_rice(mode) && rice_total < n * width)
+        {
+            *w.p++ = RICE_BLOCK | k;
+            for (int i = 0; i < n; i++)
+            {
+                int q = residual[i] >> k;
+                if (q < RICE_ESCAPE)
+                {
+                    put_bits(&w, (1u << q) - 1, q + 1);
+                    if (k) put_bits(&w, residual[i] & ((1u << k) - 1), k);
+                }
+                else
+                {
+                    put_bits(&w, (1u << RICE_ESCAPE) - 1, RICE_ESCAPE);
+                    put_bits(&w, residual[i], 16);
+                }
+            }
+        }
+        else
+        {
+            *w.p++ = width;
+            for (int i = 0; i < n; i++) put_bits(&w, residual[i], width);
+        }
+        flush_bits(&w);
+    }
+    return w.p - out;
+}
+
+// 返回消耗的字节数，数据不完整或块头非法时返回 -1
+int frame_codec_decode(frame_codec_mode_t mode, const uint8_t *in, int size, const uint16_t *reference, int count, uint16_t *words)
+{
+    bit_reader_t r = {in, in + size, 0, 0};
+
+    if (mode == FRAME_CODEC_RAW)
+    {
+        if (size < count * 2) return -1;
+        for (int i = 0; i < count; i++, r.p += 2)
+        {
+            words[i] = r.p[0] | (r.p[1] << 8);
+        }
+        return r.p - in;
+    }
+    if (mode >= FRAME_CODEC_MODE_NUM) return -1;
+
+    for (int block = 0; block < count; block += FRAME_CODEC_BLOCK)
+    {
+        int n = count - block < FRAME_CODEC_BLOCK ? count - block : FRAME_CODEC_BLOCK;
+        if (r.p >= r.end) return -1;
+        int head = *r.p++;
+        r.bits = 0;
+        r.used = 0;
+
+        if (head & RICE_BLOCK)
+        {
+            int k = head & ~RICE_BLOCK;
+            if (!is_rice(mode) || k > RICE_K_MAX) return -1;
+            for (int i = 0; i < n; i++)
+            {
+                uint16_t residual;
+                int q = 0;
+                while (q < RICE_ESCAPE)
+                {
+                    if (fill_bits(&r, 1) < 0) return -1;
+                    if (!take_bits(&r, 1)) break;
+                    q++;
+                }
+                if (q == RICE_ESCAPE)
+                {
+                    if (fill_bits(&r, 16) < 0) return -1;
+                    residual = take_bits(&r, 16);
+                }
+                else
+                {
+                    if (k && fill_bits(&r, k) < 0) return -1;
+                    residual = (q << k) | (k ? take_bits(&r, k) : 0);
+                }
+                words[block + i] = unzigzag(residual) + predict(mode, words, reference, block + i);
+            }
+        }
+        else
+        {
+            int width = head;
+            if (width > 16) return -1;
+            for (int i = 0; i < n; i++)
+            {
+                if (width && fill_bits(&r, width) < 0) return -1;
+                uint16_t residual = width ? take_bits(&r, width) : 0;
+                words[block + i] = unzigzag(residual) + predict(mode, words, reference, block + i);
+            }
+        }
+    }
+    return r.p - in;
+}
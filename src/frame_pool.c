@@ -0,0 +1,78 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "include/frame_pool.h"
+
+static thermal_frame_t *pool_frames;
+static int pool_count;
+static uint32_t pool_sequence;
+static frame_pool_stats_t pool_stats;
+
+void frame_pool_init(thermal_frame_t *frames, int count)
+{
+    pool_frames = frames;
+    pool_count = count;
+    pool_sequence = 0;
+    for (int i = 0; i < count; i++)
+    {
+        frames[i].refs = 0;
+    }
+}
+
+// 取一个空闲帧，引用计数为 1；池耗尽时返回 NULL 并计数
+thermal_frame_t *frame_pool_acquire(void)
+{
+    thermal_frame_t *frame = NULL;
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < pool_count; i++)
+    {
+        if (pool_frames[i].refs == 0)
+        {
+            frame = &pool_frames[i];
+            frame->refs = 1;
+            frame->sequence = pool_sequence++;
+            break;
+        }
+    }
+    if (frame != NULL)
+    {
+        pool_stats.acquired++;
+        pool_stats.in_use++;
+        if (pool_stats.in_use > pool_stats.in_use_max) pool_stats.in_use_max = pool_stats.in_use;
+    }
+    else
+    {
+        pool_stats.exhausted++;
+    }
+    taskEXIT_CRITICAL();
+
+    return frame;
+}
+
+// 交给下一阶段前增加引用，各阶段用完后各自 release
+void frame_pool_retain(thermal_frame_t *frame)
+{
+    taskENTER_CRITICAL();
+    frame->refs++;
+    taskEXIT_CRITICAL();
+}
+
+void frame_pool_release(thermal_frame_t *frame)
+{
+    taskENTER_CRITICAL();
+    configASSERT(frame->refs > 0);
+    frame->refs--;
+    if (frame->refs == 0)
+    {
+        pool_stats.released++;
+        pool_stats.in_use--;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void frame_pool_get_stats(frame_pool_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = pool_stats;
+    taskEXIT_CRITICAL();
+}
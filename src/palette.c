@@ -0,0 +1,64 @@
+#include "include/palette.h"
+
+#define PALETTE_WIDTH 32
+#define PALETTE_HEIGHT 24
+
+static inline int normalize_index(float temp, float min_temp, float max_temp)
+{
+    // NaN 也落到 0，与 ARM 上浮点转整数的饱和结果一致
+    if (!(temp >= min_temp)) return 0;
+    if (temp > max_temp) return 255;
+    return (temp - min_temp) / (max_temp - min_temp) * 255;
+}
+
+void palette_colorize(const float *temps, float min_temp, float max_temp, const uint16_t *lut, uint16_t *color)
+{
+    for (int i = 0; i < PALETTE_HEIGHT; i++)
+    {
+        for (int j = 0; j < PALETTE_WIDTH; j++)
+        {
+            color[i * PALETTE_WIDTH + PALETTE_WIDTH - 1 - j] = lut[normalize_index(temps[PALETTE_WIDTH * i + j], min_temp, max_temp)];
+        }
+    }
+}
+
+void palette_index(const float *temps, float min_temp, float max_temp, uint8_t *index)
+{
+    for (int i = 0; i < PALETTE_HEIGHT; i++)
+    {
+        for (int j = 0; j < PALETTE_WIDTH; j++)
+        {
+            index[i * PALETTE_WIDTH + PALETTE_WIDTH - 1 - j] = normalize_index(temps[PALETTE_WIDTH * i + j], min_temp, max_temp);
+        }
+    }
+}
+
+// TEMP_CENTI_INVALID 是 int16 最小值，总是落到 0
+static inline int normalize_index_centi(int32_t temp, int32_t min_temp, int32_t max_temp)
+{
+    if (temp < min_temp) return 0;
+    if (temp > max_temp) return 255;
+    return (temp - min_temp) * 255 / (max_temp - min_temp);
+}
+
+void palette_colorize_centi(const int16_t *temps, int16_t min_temp, int16_t max_temp, const uint16_t *lut, uint16_t *color)
+{
+    for (int i = 0; i < PALETTE_HEIGHT; i++)
+    {
+        for (int j = 0; j < PALETTE_WIDTH; j++)
+        {
+            color[i * PALETTE_WIDTH + PALETTE_WIDTH - 1 - j] = lut[normalize_index_centi(temps[PALETTE_WIDTH * i + j], min_temp, max_temp)];
+        }
+    }
+}
+
+void palette_index_centi(const int16_t *temps, int16_t min_temp, int16_t max_temp, uint8_t *index)
+{
+    for (int i = 0; i < PALETTE_HEIGHT; i++)
+    {
+        for (int j = 0; j < PALETTE_WIDTH; j++)
+        {
+            index[i * PALETTE_WIDTH + PALETTE_WIDTH - 1 - j] = normalize_index_centi(temps[PALETTE_WIDTH * i + j], min_temp, max_temp);
+        }
+    }
+}
@@ -0,0 +1,220 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "include/pixel_detector.h"
+
+typedef struct
+{
+    int16_t last_raw;
+    int16_t mean;       // 温度 EWMA，0.01°C
+    uint16_t var;       // 偏差平方 EWMA，饱和
+    uint8_t stuck;
+    uint8_t suspect;
+    uint8_t flags;
+} pixel_state_t;
+
+#define PIXEL_KNOWN 0x01    // 已在修正表中，不再检测
+#define PIXEL_SEEN 0x02     // EWMA 已用首个样本初始化
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t count;
+    uint16_t pixels[PIXEL_DETECTOR_MAX];
+} pixel_detector_record_t;
+
+static pixel_state_t pixel_state[MLX90640_PIXEL_NUM];
+static badPixelPlanMLX90640 *detector_plan;
+static paramsMLX90640 *detector_params;
+static int detector_mode;
+static pixel_detector_record_t record;
+static pixel_detector_stats_t detector_stats;
+static uint32_t retry_frame;
+
+static void detector_flash_write(__unused void *param)
+{
+    static uint8_t page[FLASH_PAGE_SIZE];
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &record, sizeof(record));
+    flash_range_erase(PIXEL_DETECTOR_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(PIXEL_DETECTOR_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+}
+
+// 修正表恢复为 EEPROM 坏点加 record 中的运行时坏点，检测状态对新加入的像素停止跟踪
+static void detector_rebuild(void)
+{
+    uint16_t count = record.count;
+
+    MLX90640_BadPixelPlanInit(detector_plan);
+    MLX90640_BadPixelPlanAddList(detector_plan, detector_params->brokenPixels, detector_mode, detector_params);
+    MLX90640_BadPixelPlanAddList(detector_plan, detector_params->outlierPixels, detector_mode, detector_params);
+    memset(pixel_state, 0, sizeof(pixel_state));
+    for (int i = 0; i < detector_plan->count; i++)
+    {
+        pixel_state[detector_plan->fix[i].pixel].flags |= PIXEL_KNOWN;
+    }
+
+    record.count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t pixel = record.pixels[i];
+        if (pixel_state[pixel].flags & PIXEL_KNOWN) continue;
+        if (MLX90640_BadPixelPlanAdd(detector_plan, pixel, detector_mode, detector_params) == MLX90640_NO_ERROR)
+        {
+            record.pixels[record.count++] = pixel;
+            pixel_state[pixel].flags |= PIXEL_KNOWN;
+        }
+    }
+    detector_stats.found = record.count;
+}
+
+// 载入之前检测到的坏点并加入修正表；plan 须已含 EEPROM 坏点
+int pixel_detector_init(badPixelPlanMLX90640 *plan, paramsMLX90640 *params, int mode)
+{
+    const pixel_detector_record_t *saved = (const pixel_detector_record_t *)(XIP_BASE + PIXEL_DETECTOR_FLASH_OFFSET);
+
+    detector_plan = plan;
+    detector_params = params;
+    detector_mode = mode;
+    memset(&record, 0, sizeof(record));
+    record.magic = PIXEL_DETECTOR_MAGIC;
+
+    if (saved->magic == PIXEL_DETECTOR_MAGIC && saved->count <= PIXEL_DETECTOR_MAX)
+    {
+        record.count = saved->count;
+        memcpy(record.pixels, saved->pixels, saved->count * sizeof(record.pixels[0]));
+    }
+    detector_rebuild();
+    return record.count;
+}
+
+// 把误判的像素移出修正表和 flash 记录，之后重新开始检测
+int pixel_detector_forget(uint16_t pixel)
+{
+    for (int i = 0; i < record.count; i++)
+    {
+        if (record.pixels[i] != pixel) continue;
+        record.pixels[i] = record.pixels[--record.count];
+        detector_rebuild();
+        detector_stats.dirty = 1;
+        return 0;
+    }
+    return -1;
+}
+
+// 清除全部运行时坏点，例如更换传感器之后
+void pixel_detector_reset(void)
+{
+    record.count = 0;
+    detector_rebuild();
+    detector_stats.dirty = 1;
+}
+
+int pixel_detector_flush(void)
+{
+    if (!detector_stats.dirty || detector_stats.frames < retry_frame) return 0;
+
+    int result = flash_safe_execute(detector_flash_write, NULL, 100);
+    if (result != PICO_OK)
+    {
+        detector_stats.flash_failures++;
+        retry_frame = detector_stats.frames + PIXEL_DETECTOR_RETRY_FRAMES;
+        return result;
+    }
+    detector_stats.flash_writes++;
+    detector_stats.dirty = 0;
+    return 0;
+}
+
+static void detector_flag(int pixel)
+{
+    if (record.count >= PIXEL_DETECTOR_MAX) return;
+    if (MLX90640_BadPixelPlanAdd(detector_plan, pixel, detector_mode, detector_params) != MLX90640_NO_ERROR) return;
+
+    pixel_state[pixel].flags |= PIXEL_KNOWN;
+    record.pixels[record.count++] = pixel;
+    detector_stats.found = record.count;
+    detector_stats.dirty = 1;
+}
+
+// 在坏点修正之后调用：修正表中的像素跳过，作为邻点时已是修正值
+int pixel_detector_update(uint16_t *frameData, const thermal_temp_t *to)
+{
+    uint32_t start_us = time_us_32();
+    int chess = MLX90640_IS_CHESS_MODE(frameData);
+    int subPage = frameData[833];
+    int flagged = 0;
+
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        int line = pixel >> 5;
+        int column = pixel & 31;
+        int pattern = MLX90640_PIXEL_PATTERN(pixel, chess);
+        pixel_state_t *state = &pixel_state[pixel];
+
+        if (pattern != subPage || (state->flags & PIXEL_KNOWN)) continue;
+
+        // 原始值在本子页更新时不变 -> 卡死
+        int16_t raw = (int16_t)frameData[pixel];
+        if (raw == state->last_raw)
+        {
+            if (state->stuck < 255) state->stuck++;
+        }
+        else
+        {
+            state->stuck = 0;
+        }
+        state->last_raw = raw;
+
+        // 时间均值/方差 EWMA，alpha = 1/8；无效温度（NaN）不参与
+        int32_t t = THERMAL_TEMP_CENTI_OF(to[pixel]);
+        if (t != TEMP_CENTI_INVALID)
+        {
+            if (!(state->flags & PIXEL_SEEN))
+            {
+                state->mean = t;
+                state->flags |= PIXEL_SEEN;
+            }
+            int32_t delta = t - state->mean;
+            state->mean += delta / 8;
+            uint32_t sq = (uint32_t)delta * (uint32_t)delta;
+            int32_t var = (int32_t)state->var + ((int32_t)(sq > 65535 ? 65535 : sq) - (int32_t)state->var) / 8;
+            state->var = var < 0 ? 0 : var;
+        }
+
+        // 方差同时明显高于四邻才算噪声像素；卡死不看邻点
+        int up = line > 0 ? pixel - 32 : pixel + 32;
+        int down = line < 23 ? pixel + 32 : pixel - 32;
+        int left = column > 0 ? pixel - 1 : pixel + 1;
+        int right = column < 31 ? pixel + 1 : pixel - 1;
+        uint32_t neighbor_var = ((uint32_t)pixel_state[up].var + pixel_state[down].var +
+                                 pixel_state[left].var + pixel_state[right].var) / 4;
+        int noisy = state->var > PIXEL_NOISE_LIMIT && state->var > PIXEL_NOISE_RATIO * neighbor_var;
+
+        if (state->stuck >= PIXEL_STUCK_FRAMES || noisy)
+        {
+            if (state->suspect < 255) state->suspect++;
+            if (state->suspect >= PIXEL_SUSPECT_FRAMES)
+            {
+                detector_flag(pixel);
+                flagged++;
+            }
+        }
+        else
+        {
+            state->suspect = 0;
+        }
+    }
+
+    detector_stats.frames++;
+    detector_stats.last_us = time_us_32() - start_us;
+    if (detector_stats.last_us > detector_stats.max_us) detector_stats.max_us = detector_stats.last_us;
+    return flagged;
+}
+
+void pixel_detector_get_stats(pixel_detector_stats_t *stats)
+{
+    *stats = detector_stats;
+}
@@ -0,0 +1,301 @@
+#include <string.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "include/recorder.h"
+#include "include/frame_codec.h"
+#include "include/thermal_memory.h"
+
+#if THERMAL_RECORDER
+
+_Static_assert(sizeof(((thermal_frame_t *)0)->frameData) == RECORDER_FRAME_WORDS * 2, "frameData does not match RECORDER_FRAME_WORDS");
+
+// 队列里只放帧指针，帧由采集任务增加引用后入队，编码完成后归还帧池
+static QueueHandle_t recorder_queue;
+static uint8_t sector[RECORDER_SECTOR_BYTES];
+static uint8_t encoded[FRAME_CODEC_MAX_BYTES(RECORDER_FRAME_WORDS)];
+static thermal_frame_t *reference;     // 上一帧，时域预测的参考，保留一个引用
+static recorder_session_t session;
+static uint32_t next_sector;
+static uint32_t sector_index;
+static int sector_frames;
+static recorder_stats_t recorder_stats;
+static bool recorder_disabled;
+
+// 链接脚本给出的固件映像末尾，录制区不能与之重叠
+extern char __flash_binary_end;
+
+_Static_assert(RECORDER_FLASH_SIZE % RECORDER_SECTOR_BYTES == 0, "RECORDER_FLASH_SIZE must be a whole number of sectors");
+_Static_assert(RECORDER_FLASH_SIZE < PIXEL_DETECTOR_FLASH_OFFSET, "RECORDER_FLASH_SIZE does not fit below the pixel detector sector");
+
+#if configSUPPORT_STATIC_ALLOCATION
+static StaticTask_t recorder_task_tcb;
+static StackType_t recorder_task_stack[RECORDER_TASK_STACK_WORDS];
+static StaticQueue_t recorder_queue_buffer;
+static uint8_t recorder_queue_storage[RECORDER_QUEUE_LENGTH * sizeof(thermal_frame_t *)];
+#endif
+
+static inline uintptr_t sector_address(uint32_t index)
+{
+    return XIP_BASE + RECORDER_FLASH_OFFSET + index * RECORDER_SECTOR_BYTES;
+}
+
+static inline const recorder_sector_header_t *sector_header(uint32_t index)
+{
+    return (const recorder_sector_header_t *)sector_address(index);
+}
+
+static bool sector_is_blank(uint32_t index)
+{
+    const uint32_t *words = (const uint32_t *)sector_address(index);
+    for (int i = 0; i < RECORDER_SECTOR_BYTES / 4; i++)
+    {
+        if (words[i] != 0xFFFFFFFF) return false;
+    }
+    return true;
+}
+
+// 调度器启动前调用，此时只有当前核在运行，直接关中断擦除
+static void erase_sectors(uint32_t first, uint32_t count)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(RECORDER_FLASH_OFFSET + first * RECORDER_SECTOR_BYTES, count * RECORDER_SECTOR_BYTES);
+    restore_interrupts(ints);
+}
+
+static void recorder_flash_program(void *param)
+{
+    flash_range_program(RECORDER_FLASH_OFFSET + next_sector * RECORDER_SECTOR_BYTES, param, RECORDER_SECTOR_BYTES);
+}
+
+static void sector_begin(void)
+{
+    recorder_sector_header_t *header = (recorder_sector_header_t *)sector;
+
+    memset(sector, 0xFF, sizeof(sector));
+    header->magic = RECORDER_SECTOR_MAGIC;
+    header->session = recorder_stats.session;
+    header->index = sector_index;
+    header->used = sizeof(recorder_sector_header_t);
+    header->records = 0;
+    sector_frames = 0;
+}
+
+static void sector_flush(void)
+{
+    recorder_sector_header_t *header = (recorder_sector_header_t *)sector;
+    uint32_t start_us = time_us_32();
+
+    if (header->records == 0) return;
+    if (flash_safe_execute(recorder_flash_program, sector, 100) == PICO_OK)
+    {
+        uint32_t write_us = time_us_32() - start_us;
+        if (write_us > recorder_stats.write_us_max) recorder_stats.write_us_max = write_us;
+        recorder_stats.sectors++;
+    }
+    next_sector++;
+    sector_index++;
+    if (next_sector >= RECORDER_SECTOR_NUM) recorder_stats.full = 1;
+    sector_begin();
+}
+
+static bool sector_append(uint8_t type, uint8_t encoding, const void *head, int head_size, const void *body, int body_size)
+{
+    recorder_sector_header_t *header = (recorder_sector_header_t *)sector;
+    recorder_record_header_t record = {type, encoding, head_size + body_size};
+
+    if (header->used + sizeof(record) + record.length > RECORDER_SECTOR_BYTES) return false;
+    memcpy(&sector[header->used], &record, sizeof(record));
+    memcpy(&sector[header->used + sizeof(record)], head, head_size);
+    memcpy(&sector[header->used + sizeof(record) + head_size], body, body_size);
+    header->used += sizeof(record) + record.length;
+    header->records++;
+    return true;
+}
+
+// 扇区内第一帧用空间预测，其余以上一帧为参考，压缩无收益时存原值
+static int encode_frame(const thermal_frame_t *frame, frame_codec_mode_t *mode)
+{
+    int size;
+
+    *mode = sector_frames == 0 || reference == NULL ? FRAME_CODEC_RICE_SPATIAL : FRAME_CODEC_RICE_TEMPORAL;
+    size = frame_codec_encode(*mode, frame->frameData, reference ? reference->frameData : NULL, RECORDER_FRAME_WORDS, encoded);
+    if (size >= RECORDER_FRAME_WORDS * 2)
+    {
+        *mode = FRAME_CODEC_RAW;
+        size = frame_codec_encode(*mode, frame->frameData, NULL, RECORDER_FRAME_WORDS, encoded);
+    }
+    return size;
+}
+
+// 编码直接读帧池中的帧；编完的帧留作下一帧的参考，换下的参考帧归还帧池
+static void record_frame(thermal_frame_t *frame)
+{
+    recorder_frame_t info = {frame->sequence, frame->time_ms, frame->acquire_us};
+    frame_codec_mode_t mode;
+    int size = encode_frame(frame, &mode);
+
+    if (!sector_append(RECORDER_RECORD_FRAME, mode, &info, sizeof(info), encoded, size))
+    {
+        sector_flush();
+        if (recorder_stats.full)
+        {
+            frame_pool_release(frame);
+            return;
+        }
+        size = encode_frame(frame, &mode);
+        sector_append(RECORDER_RECORD_FRAME, mode, &info, sizeof(info), encoded, size);
+    }
+    if (reference != NULL) frame_pool_release(reference);
+    reference = frame;
+    sector_frames++;
+    recorder_stats.frames++;
+    recorder_stats.raw_bytes += sizeof(frame->frameData);
+    recorder_stats.encoded_bytes += size;
+}
+
+static void recorder_task(__unused void *pvParameters)
+{
+    thermal_frame_t *frame;
+
+    sector_begin();
+    sector_append(RECORDER_RECORD_SESSION, FRAME_CODEC_RAW, &session, sizeof(session), NULL, 0);
+    while (!recorder_stats.full)
+    {
+        xQueueReceive(recorder_queue, &frame, portMAX_DELAY);
+        record_frame(frame);
+    }
+    // 录满后不再入队，归还参考帧和队列里剩下的帧
+    if (reference != NULL) frame_pool_release(reference);
+    reference = NULL;
+    while (xQueueReceive(recorder_queue, &frame, 0) == pdTRUE)
+    {
+        frame_pool_release(frame);
+    }
+    printf("recorder: flash region full after %lu frames\n", (unsigned long)recorder_stats.frames);
+    vTaskDelete(NULL);
+}
+
+// 找到日志末尾并保证其后的扇区已擦除，返回可用扇区数
+// 录制区与固件重叠时不擦写任何扇区，之后的帧全部计入 dropped
+int recorder_init(const uint16_t *eeData, uint8_t refresh_rate, uint8_t resolution, uint8_t chess_mode)
+{
+    uint32_t last_session = 0;
+
+    memset(&recorder_stats, 0, sizeof(recorder_stats));
+    recorder_disabled = (uintptr_t)&__flash_binary_end > XIP_BASE + RECORDER_FLASH_OFFSET;
+    if (recorder_disabled)
+    {
+        printf("recorder: region at 0x%08lx overlaps firmware ending at 0x%08lx, recording disabled\n",
+               (unsigned long)(XIP_BASE + RECORDER_FLASH_OFFSET), (unsigned long)(uintptr_t)&__flash_binary_end);
+        recorder_stats.full = 1;
+        return 0;
+    }
+
+    next_sector = 0;
+    while (next_sector < RECORDER_SECTOR_NUM && sector_header(next_sector)->magic == RECORDER_SECTOR_MAGIC)
+    {
+        if (sector_header(next_sector)->session > last_session) last_session = sector_header(next_sector)->session;
+        next_sector++;
+    }
+
+    if (RECORDER_SECTOR_NUM - next_sector < RECORDER_MIN_FREE_SECTORS)
+    {
+        printf("recorder: log full, erasing %d KB\n", RECORDER_FLASH_SIZE / 1024);
+        erase_sectors(0, RECORDER_SECTOR_NUM);
+        next_sector = 0;
+        last_session = 0;
+    }
+    else
+    {
+        for (uint32_t i = next_sector; i < RECORDER_SECTOR_NUM; i++)
+        {
+            if (!sector_is_blank(i))
+            {
+                erase_sectors(i, RECORDER_SECTOR_NUM - i);
+                break;
+            }
+        }
+    }
+
+    recorder_stats.session = last_session + 1;
+    recorder_stats.sectors = next_sector;
+    sector_index = 0;
+
+    session.refresh_rate = refresh_rate;
+    session.resolution = resolution;
+    session.chess_mode = chess_mode;
+    session.reserved = 0;
+    memcpy(session.eeData, eeData, sizeof(session.eeData));
+
+#if configSUPPORT_STATIC_ALLOCATION
+    recorder_queue = xQueueCreateStatic(RECORDER_QUEUE_LENGTH, sizeof(thermal_frame_t *), recorder_queue_storage, &recorder_queue_buffer);
+#else
+    recorder_queue = xQueueCreate(RECORDER_QUEUE_LENGTH, sizeof(thermal_frame_t *));
+#endif
+    return RECORDER_SECTOR_NUM - next_sector;
+}
+
+void recorder_start(void)
+{
+    if (recorder_disabled) return;
+#if configSUPPORT_STATIC_ALLOCATION
+    xTaskCreateStatic(recorder_task, "recThread", RECORDER_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1,
+                      recorder_task_stack, &recorder_task_tcb);
+#else
+    xTaskCreate(recorder_task, "recThread", RECORDER_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1, NULL);
+#endif
+}
+
+// 采集任务调用，不阻塞：增加引用后只把帧指针入队，队列满时丢弃并计数
+void recorder_submit(thermal_frame_t *frame)
+{
+    if (recorder_stats.full)
+    {
+        recorder_stats.dropped++;
+        return;
+    }
+    frame_pool_retain(frame);
+    if (xQueueSend(recorder_queue, &frame, 0) != pdTRUE)
+    {
+        frame_pool_release(frame);
+        recorder_stats.dropped++;
+    }
+}
+
+void recorder_get_stats(recorder_stats_t *stats)
+{
+    *stats = recorder_stats;
+}
+
+#else
+
+int recorder_init(const uint16_t *eeData, uint8_t refresh_rate, uint8_t resolution, uint8_t chess_mode)
+{
+    (void)eeData;
+    (void)refresh_rate;
+    (void)resolution;
+    (void)chess_mode;
+    return 0;
+}
+
+void recorder_start(void)
+{
+}
+
+void recorder_submit(thermal_frame_t *frame)
+{
+    (void)frame;
+}
+
+void recorder_get_stats(recorder_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
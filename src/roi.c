@@ -0,0 +1,190 @@
+#include <math.h>
+#include <string.h>
+#include "include/roi.h"
+
+#define ROI_WIDTH 32
+#define ROI_HEIGHT 24
+
+// 每像素一个字节，第 i 位表示属于第 i 个 ROI；roi_pixels 为至少属于一个 ROI 的像素列表
+static uint8_t roi_map[MLX90640_PIXEL_NUM];
+static uint16_t roi_pixels[MLX90640_PIXEL_NUM];
+static uint16_t roi_pixel_count;
+static uint8_t roi_count;
+static roi_stats_t roi_stats[ROI_MAX];
+
+static inline void roi_mark(int x, int y, uint8_t bit)
+{
+    if (x < 0 || x >= ROI_WIDTH || y < 0 || y >= ROI_HEIGHT) return;
+    roi_map[y * ROI_WIDTH + x] |= bit;
+}
+
+// 新 ROI 的掩码写完后重建像素列表，空掩码不占用编号
+static int roi_commit(void)
+{
+    uint8_t bit = 1 << roi_count;
+    int marked = 0;
+
+    roi_pixel_count = 0;
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        if (roi_map[pixel] & bit) marked = 1;
+        if (roi_map[pixel]) roi_pixels[roi_pixel_count++] = pixel;
+    }
+    if (!marked) return -1;
+    memset(&roi_stats[roi_count], 0, sizeof(roi_stats[roi_count]));
+    return roi_count++;
+}
+
+void roi_init(void)
+{
+    memset(roi_map, 0, sizeof(roi_map));
+    memset(roi_stats, 0, sizeof(roi_stats));
+    roi_pixel_count = 0;
+    roi_count = 0;
+}
+
+int roi_add_rect(int x0, int y0, int x1, int y1)
+{
+    if (roi_count >= ROI_MAX) return -1;
+    uint8_t bit = 1 << roi_count;
+    for (int y = (y0 < y1 ? y0 : y1); y <= (y0 < y1 ? y1 : y0); y++)
+    {
+        for (int x = (x0 < x1 ? x0 : x1); x <= (x0 < x1 ? x1 : x0); x++)
+        {
+            roi_mark(x, y, bit);
+        }
+    }
+    return roi_commit();
+}
+
+// 圆内判据用 r^2 + r（像素中心距离不超过 r + 0.5）：radius 0 为单个像素，1 为 3x3 方块，2 为去掉四角的 5x5
+int roi_add_spot(int x, int y, int radius)
+{
+    if (roi_count >= ROI_MAX) return -1;
+    uint8_t bit = 1 << roi_count;
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            if (dx * dx + dy * dy <= radius * radius + radius) roi_mark(x + dx, y + dy, bit);
+        }
+    }
+    return roi_commit();
+}
+
+// Bresenham 直线，包含两个端点
+int roi_add_line(int x0, int y0, int x1, int y1)
+{
+    if (roi_count >= ROI_MAX) return -1;
+    uint8_t bit = 1 << roi_count;
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int dy = y1 > y0 ? y0 - y1 : y1 - y0;
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while (1)
+    {
+        roi_mark(x0, y0, bit);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+    return roi_commit();
+}
+
+// 顶点为像素坐标，按奇偶规则判断像素中心是否在多边形内；只在配置时运行一次
+int roi_add_polygon(const roi_point_t *points, int count)
+{
+    if (roi_count >= ROI_MAX || count < 3 || count > ROI_POLYGON_MAX) return -1;
+    uint8_t bit = 1 << roi_count;
+    for (int y = 0; y < ROI_HEIGHT; y++)
+    {
+        for (int x = 0; x < ROI_WIDTH; x++)
+        {
+            int inside = 0;
+            for (int i = 0, j = count - 1; i < count; j = i++)
+            {
+                const roi_point_t *a = &points[i];
+                const roi_point_t *b = &points[j];
+                if ((a->y > y) != (b->y > y) &&
+                    x < (float)(b->x - a->x) * (y - a->y) / (b->y - a->y) + a->x)
+                {
+                    inside = !inside;
+                }
+            }
+            if (inside) roi_mark(x, y, bit);
+        }
+    }
+    return roi_commit();
+}
+
+static inline int16_t roi_centi(thermal_temp_t t)
+{
+#if THERMAL_TEMP_CENTI
+    return t;
+#else
+    return temp_to_centi(t);
+#endif
+}
+
+// 无效像素（NaN/越界）不计入；方差用整数和与平方和一次算出
+// 单独一趟遍历：To 循环只见到本子页、坏点修正前的像素，且分在两个核上，统计需要修正后的整幅温度场。
+// 代价不可忽略：每帧多遍历一次所有 ROI 像素，replay_bench 的 roi_stats 阶段约 3 us/帧，固件实测值显示在屏幕 ROI 一行
+void roi_update(const thermal_temp_t *to)
+{
+    int32_t sum[ROI_MAX] = {0};
+    uint64_t square[ROI_MAX] = {0};
+    uint16_t count[ROI_MAX] = {0};
+    int16_t min[ROI_MAX];
+    int16_t max[ROI_MAX];
+    uint16_t min_pixel[ROI_MAX] = {0};
+    uint16_t max_pixel[ROI_MAX] = {0};
+
+    for (int r = 0; r < roi_count; r++)
+    {
+        min[r] = INT16_MAX;
+        max[r] = INT16_MIN;
+    }
+
+    for (int i = 0; i < roi_pixel_count; i++)
+    {
+        uint16_t pixel = roi_pixels[i];
+        int16_t t = roi_centi(to[pixel]);
+        if (t == TEMP_CENTI_INVALID) continue;
+
+        for (uint8_t bits = roi_map[pixel], r = 0; bits; bits >>= 1, r++)
+        {
+            if (!(bits & 1)) continue;
+            sum[r] += t;
+            square[r] += (uint32_t)((int32_t)t * t);
+            count[r]++;
+            if (t < min[r]) { min[r] = t; min_pixel[r] = pixel; }
+            if (t > max[r]) { max[r] = t; max_pixel[r] = pixel; }
+        }
+    }
+
+    for (int r = 0; r < roi_count; r++)
+    {
+        roi_stats_t *stats = &roi_stats[r];
+        int32_t n = count[r];
+
+        stats->count = n;
+        if (n == 0) continue;
+        stats->min = min[r];
+        stats->max = max[r];
+        stats->min_pixel = min_pixel[r];
+        stats->max_pixel = max_pixel[r];
+        stats->mean = (sum[r] + (sum[r] >= 0 ? n / 2 : -n / 2)) / n;
+        // n^2 * var = n * sum(t^2) - sum(t)^2
+        int64_t spread = (int64_t)n * (int64_t)square[r] - (int64_t)sum[r] * sum[r];
+        stats->stddev = spread > 0 ? (uint16_t)(sqrtf((float)spread) / n + 0.5f) : 0;
+    }
+}
+
+int roi_get_stats(roi_stats_t *stats)
+{
+    memcpy(stats, roi_stats, roi_count * sizeof(roi_stats_t));
+    return roi_count;
+}
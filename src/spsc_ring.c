@@ -0,0 +1,84 @@
+#include "include/spsc_ring.h"
+
+#define RING_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+void spsc_ring_init(spsc_ring_t *ring, spsc_ring_policy_t policy)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->policy = policy;
+}
+
+uint32_t spsc_ring_depth(const spsc_ring_t *ring)
+{
+    return RING_LOAD_ACQUIRE(&ring->head) - RING_LOAD_ACQUIRE(&ring->tail);
+}
+
+// 阻塞到对端通知或超时；通知计数在检查队列与开始等待之间到达也不会丢
+static bool ring_wait(TimeOut_t *start, TickType_t *timeout)
+{
+    if (xTaskCheckForTimeOut(start, timeout) != pdFALSE) return false;
+    ulTaskNotifyTake(pdTRUE, *timeout);
+    return true;
+}
+
+static void ring_wake(TaskHandle_t task)
+{
+    if (task != NULL) xTaskNotifyGive(task);
+}
+
+bool spsc_ring_push(spsc_ring_t *ring, thermal_frame_t *frame, TickType_t timeout)
+{
+    uint32_t head = ring->head;
+    uint32_t depth;
+    TimeOut_t start;
+
+    ring->producer = xTaskGetCurrentTaskHandle();
+    vTaskSetTimeOutState(&start);
+    while (head - RING_LOAD_ACQUIRE(&ring->tail) >= SPSC_RING_CAPACITY)
+    {
+        if (ring->policy == SPSC_RING_DROP_NEWEST)
+        {
+            // 生产者不碰 tail，满时丢弃的是新帧，因此不需要和消费者互斥
+            ring->stats.overruns++;
+            frame_pool_release(frame);
+            return true;
+        }
+        ring->stats.producer_waits++;
+        if (!ring_wait(&start, &timeout))
+        {
+            ring->stats.overruns++;
+            return false;
+        }
+    }
+
+    ring->slots[head & (SPSC_RING_CAPACITY - 1)] = frame;
+    RING_STORE_RELEASE(&ring->head, head + 1);
+    ring->stats.pushed++;
+    depth = head + 1 - RING_LOAD_ACQUIRE(&ring->tail);
+    if (depth > ring->stats.depth_max) ring->stats.depth_max = depth;
+    ring_wake(ring->consumer);
+    return true;
+}
+
+thermal_frame_t *spsc_ring_pop(spsc_ring_t *ring, TickType_t timeout)
+{
+    thermal_frame_t *frame;
+    uint32_t tail = ring->tail;
+    TimeOut_t start;
+
+    // 先登记再检查，之后的 push 一定会通知到本任务
+    ring->consumer = xTaskGetCurrentTaskHandle();
+    vTaskSetTimeOutState(&start);
+    while (RING_LOAD_ACQUIRE(&ring->head) == tail)
+    {
+        ring->stats.consumer_waits++;
+        if (!ring_wait(&start, &timeout)) return NULL;
+    }
+
+    frame = ring->slots[tail & (SPSC_RING_CAPACITY - 1)];
+    RING_STORE_RELEASE(&ring->tail, tail + 1);
+    ring->stats.popped++;
+    ring_wake(ring->producer);
+    return frame;
+}
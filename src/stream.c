@@ -0,0 +1,234 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "stream_buffer.h"
+#include "include/stream.h"
+#include "include/thermal_memory.h"
+
+#if THERMAL_STREAM
+
+#include "pico/stdio_usb.h"
+
+static stream_stats_t stream_stats;
+
+#if configSUPPORT_STATIC_ALLOCATION
+static StaticTask_t stream_task_tcb;
+static StackType_t stream_task_stack[STREAM_TASK_STACK_WORDS];
+#endif
+
+#if THERMAL_STREAM_MODE == STREAM_MODE_RAW
+
+static QueueHandle_t stream_raw_queue;
+
+#if configSUPPORT_STATIC_ALLOCATION
+static StaticQueue_t stream_raw_queue_buffer;
+static uint8_t stream_raw_queue_storage[STREAM_RAW_QUEUE_LENGTH * sizeof(thermal_frame_t *)];
+#endif
+
+void stream_send_temperatures(uint32_t sequence, const thermal_temp_t *to)
+{
+    (void)sequence;
+    (void)to;
+}
+
+void stream_send_roi(uint32_t sequence, const roi_stats_t *stats, int count)
+{
+    (void)sequence;
+    (void)stats;
+    (void)count;
+}
+
+// 采集任务调用，不阻塞：增加引用后只把帧指针入队，队列满时整帧丢弃
+void stream_send_raw(thermal_frame_t *frame)
+{
+    if (!stdio_usb_connected())
+    {
+        stream_stats.disconnected++;
+        return;
+    }
+    frame_pool_retain(frame);
+    if (xQueueSend(stream_raw_queue, &frame, 0) != pdTRUE)
+    {
+        frame_pool_release(frame);
+        stream_stats.dropped++;
+    }
+}
+
+// 包头、载荷、CRC 分三次写出，载荷直接取自帧池，写完归还引用
+static void stream_task(__unused void *pvParameters)
+{
+    thermal_frame_t *frame;
+    while (1)
+    {
+        xQueueReceive(stream_raw_queue, &frame, portMAX_DELAY);
+        stream_header_t header = {STREAM_SYNC, STREAM_VERSION, STREAM_TYPE_RAW, sizeof(frame->frameData),
+                                  frame->sequence, frame->time_ms};
+        uint16_t crc = stream_crc16(0xFFFF, (const uint8_t *)&header, sizeof(header));
+        crc = stream_crc16(crc, (const uint8_t *)frame->frameData, sizeof(frame->frameData));
+        uint8_t tail[2] = {crc & 0xFF, crc >> 8};
+
+        stdio_usb.out_chars((const char *)&header, sizeof(header));
+        stdio_usb.out_chars((const char *)frame->frameData, sizeof(frame->frameData));
+        stdio_usb.out_chars((const char *)tail, sizeof(tail));
+        frame_pool_release(frame);
+        stream_stats.packets++;
+        stream_stats.bytes += sizeof(header) + sizeof(frame->frameData) + sizeof(tail);
+    }
+}
+
+void stream_init(void)
+{
+    // USB 只传二进制流，文本输出留在 UART
+    stdio_set_driver_enabled(&stdio_usb, false);
+#if configSUPPORT_STATIC_ALLOCATION
+    stream_raw_queue = xQueueCreateStatic(STREAM_RAW_QUEUE_LENGTH, sizeof(thermal_frame_t *), stream_raw_queue_storage,
+                                          &stream_raw_queue_buffer);
+    xTaskCreateStatic(stream_task, "streamThread", STREAM_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1,
+                      stream_task_stack, &stream_task_tcb);
+#else
+    stream_raw_queue = xQueueCreate(STREAM_RAW_QUEUE_LENGTH, sizeof(thermal_frame_t *));
+    xTaskCreate(stream_task, "streamThread", STREAM_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1, NULL);
+#endif
+}
+
+#else
+
+static StreamBufferHandle_t stream_buffer;
+
+#if configSUPPORT_STATIC_ALLOCATION
+static StaticStreamBuffer_t stream_buffer_struct;
+static uint8_t stream_buffer_storage[STREAM_BUFFER_BYTES + 1];
+#endif
+
+// 单一生产者：处理任务
+static void stream_packet(uint8_t type, uint32_t sequence, const void *payload, int length)
+{
+    static uint8_t packet[STREAM_PACKET_MAX];
+    stream_header_t header = {STREAM_SYNC, STREAM_VERSION, type, length, sequence, time_us_64() / 1000};
+    int size = sizeof(header) + length + 2;
+
+    if (!stdio_usb_connected())
+    {
+        stream_stats.disconnected++;
+        return;
+    }
+    if (xStreamBufferSpacesAvailable(stream_buffer) < (size_t)size)
+    {
+        stream_stats.dropped++;
+        return;
+    }
+
+    memcpy(packet, &header, sizeof(header));
+    memcpy(&packet[sizeof(header)], payload, length);
+    uint16_t crc = stream_crc16(0xFFFF, packet, sizeof(header) + length);
+    packet[size - 2] = crc & 0xFF;
+    packet[size - 1] = crc >> 8;
+    xStreamBufferSend(stream_buffer, packet, size, 0);
+    stream_stats.packets++;
+    stream_stats.bytes += size;
+}
+
+// 紧凑温度场本身就是流格式，直接发送
+void stream_send_temperatures(uint32_t sequence, const thermal_temp_t *to)
+{
+#if THERMAL_TEMP_CENTI
+    stream_packet(STREAM_TYPE_TEMPERATURE, sequence, to, STREAM_PIXEL_NUM * sizeof(int16_t));
+#else
+    static int16_t centi[STREAM_PIXEL_NUM];
+
+    temp_centi_from_float(to, centi, STREAM_PIXEL_NUM);
+    stream_packet(STREAM_TYPE_TEMPERATURE, sequence, centi, sizeof(centi));
+#endif
+}
+
+// 与温度包同由处理任务发送
+void stream_send_roi(uint32_t sequence, const roi_stats_t *stats, int count)
+{
+    stream_roi_t roi[STREAM_ROI_NUM];
+
+    memset(roi, 0, sizeof(roi));
+    for (int i = 0; i < count && i < STREAM_ROI_NUM; i++)
+    {
+        roi[i].count = stats[i].count;
+        roi[i].min = stats[i].min;
+        roi[i].max = stats[i].max;
+        roi[i].mean = stats[i].mean;
+        roi[i].stddev = stats[i].stddev;
+        roi[i].min_pixel = stats[i].min_pixel;
+        roi[i].max_pixel = stats[i].max_pixel;
+    }
+    stream_packet(STREAM_TYPE_ROI, sequence, roi, sizeof(roi));
+}
+
+void stream_send_raw(thermal_frame_t *frame)
+{
+    (void)frame;
+}
+
+// USB 写满时 out_chars 在本任务内等待，生产者不受影响
+static void stream_task(__unused void *pvParameters)
+{
+    static uint8_t chunk[STREAM_CHUNK_BYTES];
+    while (1)
+    {
+        size_t length = xStreamBufferReceive(stream_buffer, chunk, sizeof(chunk), portMAX_DELAY);
+        if (length > 0)
+        {
+            stdio_usb.out_chars((const char *)chunk, length);
+        }
+    }
+}
+
+void stream_init(void)
+{
+    // USB 只传二进制流，文本输出留在 UART
+    stdio_set_driver_enabled(&stdio_usb, false);
+#if configSUPPORT_STATIC_ALLOCATION
+    stream_buffer = xStreamBufferCreateStatic(STREAM_BUFFER_BYTES, 1, stream_buffer_storage, &stream_buffer_struct);
+    xTaskCreateStatic(stream_task, "streamThread", STREAM_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1,
+                      stream_task_stack, &stream_task_tcb);
+#else
+    stream_buffer = xStreamBufferCreate(STREAM_BUFFER_BYTES, 1);
+    xTaskCreate(stream_task, "streamThread", STREAM_TASK_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1, NULL);
+#endif
+}
+
+#endif
+
+void stream_get_stats(stream_stats_t *stats)
+{
+    *stats = stream_stats;
+}
+
+#else
+
+void stream_init(void)
+{
+}
+
+void stream_send_temperatures(uint32_t sequence, const thermal_temp_t *to)
+{
+    (void)sequence;
+    (void)to;
+}
+
+void stream_send_raw(thermal_frame_t *frame)
+{
+    (void)frame;
+}
+
+void stream_send_roi(uint32_t sequence, const roi_stats_t *stats, int count)
+{
+    (void)sequence;
+    (void)stats;
+    (void)count;
+}
+
+void stream_get_stats(stream_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include "include/temp_centi.h"
+
+// 下限留给 TEMP_CENTI_INVALID，外推结果不会被当成无效值
+static inline int16_t saturate_centi(int32_t t)
+{
+    if (t > INT16_MAX) return INT16_MAX;
+    if (t < INT16_MIN + 1) return INT16_MIN + 1;
+    return t;
+}
+
+// 有无效邻点时退化为其余有效邻点的平均，全部无效则结果也无效
+static int16_t neighbor_valid_mean(const int16_t *to, const uint16_t *n, int count)
+{
+    int32_t sum = 0;
+    int valid = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (to[n[i]] != TEMP_CENTI_INVALID)
+        {
+            sum += to[n[i]];
+            valid++;
+        }
+    }
+    return valid ? sum / valid : TEMP_CENTI_INVALID;
+}
+
+void temp_centi_from_float(const float *to, int16_t *centi, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        centi[i] = temp_to_centi(to[i]);
+    }
+}
+
+void temp_centi_to_float(const int16_t *centi, float *to, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        to[i] = temp_from_centi(centi[i]);
+    }
+}
+
+// 只转换本子页刷新的像素，另一半由调用者从上一帧沿用
+void temp_centi_update(uint16_t *frameData, const float *to, int16_t *centi)
+{
+    int chess = MLX90640_IS_CHESS_MODE(frameData);
+    int subPage = frameData[833];
+
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        if (MLX90640_PIXEL_PATTERN(pixel, chess) == subPage)
+        {
+            centi[pixel] = temp_to_centi(to[pixel]);
+        }
+    }
+}
+
+// 与 MLX90640_BadPixelPlanApply 相同的修正方法，全部整数运算
+void temp_centi_bad_pixel_apply(const badPixelPlanMLX90640 *plan, int16_t *to)
+{
+    for (int i = 0; i < plan->count; i++)
+    {
+        const badPixelFixMLX90640 *fix = &plan->fix[i];
+        const uint16_t *n = fix->neighbors;
+        int32_t a, b, c, d, t;
+
+        switch (fix->method)
+        {
+            case MLX90640_BAD_PIXEL_COPY:
+                to[fix->pixel] = to[n[0]];
+                break;
+            case MLX90640_BAD_PIXEL_MEAN2:
+                to[fix->pixel] = neighbor_valid_mean(to, n, 2);
+                break;
+            case MLX90640_BAD_PIXEL_MEDIAN4:
+                if (to[n[0]] == TEMP_CENTI_INVALID || to[n[1]] == TEMP_CENTI_INVALID ||
+                    to[n[2]] == TEMP_CENTI_INVALID || to[n[3]] == TEMP_CENTI_INVALID)
+                {
+                    to[fix->pixel] = neighbor_valid_mean(to, n, 4);
+                    break;
+                }
+                a = to[n[0]];
+                b = to[n[1]];
+                c = to[n[2]];
+                d = to[n[3]];
+                if (b < a) { t = a; a = b; b = t; }
+                if (d < c) { t = c; c = d; d = t; }
+                if (c < a) { t = a; a = c; c = t; }
+                if (d < b) { t = b; b = d; d = t; }
+                if (c < b) { t = b; b = c; c = t; }
+                to[fix->pixel] = (c + b) / 2;
+                break;
+            default:
+                if (to[n[0]] == TEMP_CENTI_INVALID || to[n[1]] == TEMP_CENTI_INVALID ||
+                    to[n[2]] == TEMP_CENTI_INVALID || to[n[3]] == TEMP_CENTI_INVALID)
+                {
+                    to[fix->pixel] = neighbor_valid_mean(to, n, 4);
+                    break;
+                }
+                a = (int32_t)to[n[2]] - to[n[3]];
+                b = (int32_t)to[n[0]] - to[n[1]];
+                if ((a < 0 ? -a : a) > (b < 0 ? -b : b))
+                {
+                    to[fix->pixel] = saturate_centi(to[n[0]] + b);
+                }
+                else
+                {
+                    to[fix->pixel] = saturate_centi(to[n[2]] + a);
+                }
+                break;
+        }
+    }
+}
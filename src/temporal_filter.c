@@ -0,0 +1,74 @@
+#include <string.h>
+#include "include/temporal_filter.h"
+
+#define Q8(x) THERMAL_TEMP_Q8(x)
+
+static temporal_filter_config_t filter_config;
+static int32_t filter_state[MLX90640_PIXEL_NUM];     // 滤波输出，Q8 °C
+static int32_t filter_variance[MLX90640_PIXEL_NUM];  // KALMAN 误差方差，Q8
+static uint8_t filter_primed;
+
+void temporal_filter_init(const temporal_filter_config_t *config)
+{
+    filter_config = *config;
+    filter_primed = 0;
+    memset(filter_variance, 0, sizeof(filter_variance));
+}
+
+// 帧间变化越大增益越高，运动区域不拖影
+static inline int32_t motion_gain(int32_t delta, int32_t min_gain)
+{
+    int32_t motion = delta < 0 ? -delta : delta;
+    motion -= filter_config.motion_low;
+    if (motion <= 0) return min_gain;
+    int32_t gain = min_gain + ((motion * (256 - min_gain)) >> filter_config.motion_shift);
+    return gain > 256 ? 256 : gain;
+}
+
+// 只更新本子页刷新的像素；另一半保持上次的滤波结果
+void temporal_filter_apply(uint16_t *frameData, const thermal_temp_t *to, thermal_temp_t *result)
+{
+    int chess = MLX90640_IS_CHESS_MODE(frameData);
+    int subPage = frameData[833];
+
+    if (filter_config.mode == TEMPORAL_FILTER_OFF)
+    {
+        memcpy(result, to, MLX90640_PIXEL_NUM * sizeof(thermal_temp_t));
+        return;
+    }
+
+    if (!filter_primed)
+    {
+        for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+        {
+            filter_state[pixel] = Q8(to[pixel]);
+            filter_variance[pixel] = filter_config.measure_noise;
+        }
+        filter_primed = 1;
+    }
+
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        if (MLX90640_PIXEL_PATTERN(pixel, chess) == subPage)
+        {
+            int32_t delta = Q8(to[pixel]) - filter_state[pixel];
+            int32_t gain;
+
+            if (filter_config.mode == TEMPORAL_FILTER_KALMAN)
+            {
+                // K = P / (P + R)，运动时把 P 抬到至少 |delta| 使增益接近 1
+                int32_t p = filter_variance[pixel] + filter_config.process_noise;
+                int32_t motion = delta < 0 ? -delta : delta;
+                if (motion > filter_config.motion_low && p < motion) p = motion;
+                gain = (p << 8) / (p + filter_config.measure_noise);
+                filter_variance[pixel] = ((256 - gain) * p) >> 8;
+            }
+            else
+            {
+                gain = motion_gain(delta, filter_config.min_gain);
+            }
+            filter_state[pixel] += (delta * gain) >> 8;
+        }
+        result[pixel] = THERMAL_TEMP_FROM_Q8(filter_state[pixel]);
+    }
+}
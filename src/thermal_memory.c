@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "include/thermal_memory.h"
+
+thermal_arena_t thermal_arena;
+
+#define ARENA_FIELD(name) \
+    printf("mem:   %-14s %6u @ %5u\n", #name, (unsigned)sizeof(thermal_arena.name), (unsigned)offsetof(thermal_arena_t, name))
+
+void thermal_memory_report(void)
+{
+    printf("mem: arena %u of %u bytes\n", (unsigned)sizeof(thermal_arena), (unsigned)THERMAL_ARENA_BUDGET);
+    ARENA_FIELD(eeData);
+    ARENA_FIELD(frames);
+    ARENA_FIELD(temperatures);
+    ARENA_FIELD(display);
+#if THERMAL_TEMP_CENTI
+    ARENA_FIELD(to_work);
+#endif
+    ARENA_FIELD(offset_cache);
+#if THERMAL_LAZY_TO
+    ARENA_FIELD(lazy_to);
+#endif
+    ARENA_FIELD(color);
+    ARENA_FIELD(palette_index);
+    ARENA_FIELD(upscale_rows);
+    ARENA_FIELD(frame_buffer);
+    printf("mem: heap4 %u bytes, static allocation %s\n", (unsigned)configTOTAL_HEAP_SIZE,
+           configSUPPORT_STATIC_ALLOCATION ? "on" : "off");
+}
+
+#if configSUPPORT_STATIC_ALLOCATION
+
+// 开启静态分配后，空闲任务和定时器任务的内存由应用提供
+static StaticTask_t idle_task_tcb;
+static StackType_t idle_task_stack[configMINIMAL_STACK_SIZE];
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   configSTACK_DEPTH_TYPE *puxIdleTaskStackSize)
+{
+    *ppxIdleTaskTCBBuffer = &idle_task_tcb;
+    *ppxIdleTaskStackBuffer = idle_task_stack;
+    *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+static StaticTask_t timer_task_tcb;
+static StackType_t timer_task_stack[configTIMER_TASK_STACK_DEPTH];
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    configSTACK_DEPTH_TYPE *puxTimerTaskStackSize)
+{
+    *ppxTimerTaskTCBBuffer = &timer_task_tcb;
+    *ppxTimerTaskStackBuffer = timer_task_stack;
+    *puxTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+#if configNUMBER_OF_CORES > 1
+static StaticTask_t passive_idle_task_tcb[configNUMBER_OF_CORES - 1];
+static StackType_t passive_idle_task_stack[configNUMBER_OF_CORES - 1][configMINIMAL_STACK_SIZE];
+
+void vApplicationGetPassiveIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                          configSTACK_DEPTH_TYPE *puxIdleTaskStackSize, BaseType_t xPassiveIdleTaskIndex)
+{
+    *ppxIdleTaskTCBBuffer = &passive_idle_task_tcb[xPassiveIdleTaskIndex];
+    *ppxIdleTaskStackBuffer = passive_idle_task_stack[xPassiveIdleTaskIndex];
+    *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+#endif
+
+#endif
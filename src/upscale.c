@@ -0,0 +1,272 @@
+#include <math.h>
+#include <stdlib.h>
+#include "include/upscale.h"
+
+#define UPSCALE_TAPS 4
+#define WEIGHT_ONE 256
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// 每个输出坐标的 4 个源坐标（已钳位）和 Q8 权重，权重和恒为 256
+typedef struct
+{
+    uint8_t index[UPSCALE_TAPS];
+    int16_t weight[UPSCALE_TAPS];
+} upscale_taps_t;
+
+typedef struct
+{
+    upscale_taps_t x[UPSCALE_DST_W];
+    upscale_taps_t y[UPSCALE_DST_H];
+} upscale_table_t;
+
+static upscale_table_t bicubic_table;
+static upscale_table_t lanczos2_table;
+// 边缘方向插值：x/y 方向的左上格点和 Q8 小数
+static uint8_t edge_base_x[UPSCALE_DST_W];
+static uint8_t edge_frac_x[UPSCALE_DST_W];
+static uint8_t edge_base_y[UPSCALE_DST_H];
+static uint8_t edge_frac_y[UPSCALE_DST_H];
+// 跨边缘方向用的陡峭过渡曲线（smoothstep 的两次复合）
+static uint8_t edge_sharpen[WEIGHT_ONE + 1];
+
+static float kernel_bicubic(float x)
+{
+    const float a = -0.5f;
+    x = fabsf(x);
+    if (x < 1.0f) return ((a + 2.0f) * x - (a + 3.0f)) * x * x + 1.0f;
+    if (x < 2.0f) return ((a * x - 5.0f * a) * x + 8.0f * a) * x - 4.0f * a;
+    return 0.0f;
+}
+
+static float kernel_lanczos2(float x)
+{
+    x = fabsf(x);
+    if (x < 1e-6f) return 1.0f;
+    if (x >= 2.0f) return 0.0f;
+    float px = (float)M_PI * x;
+    return 2.0f * sinf(px) * sinf(px / 2.0f) / (px * px);
+}
+
+static void build_taps(upscale_taps_t *taps, int dst, int src_size, int dst_size, float (*kernel)(float))
+{
+    float pos = (float)dst * (src_size - 1) / (dst_size - 1);
+    int base = (int)pos;
+    float frac = pos - base;
+    float w[UPSCALE_TAPS];
+    float sum = 0.0f;
+    int total = 0;
+
+    for (int i = 0; i < UPSCALE_TAPS; i++)
+    {
+        int index = base - 1 + i;
+        if (index < 0) index = 0;
+        if (index > src_size - 1) index = src_size - 1;
+        taps->index[i] = index;
+        w[i] = kernel(frac - (i - 1));
+        sum += w[i];
+    }
+    for (int i = 0; i < UPSCALE_TAPS; i++)
+    {
+        taps->weight[i] = (int16_t)lroundf(w[i] / sum * WEIGHT_ONE);
+        total += taps->weight[i];
+    }
+    // 舍入误差补到中心抽头，保证平坦区域输出不漂移
+    taps->weight[frac < 0.5f ? 1 : 2] += WEIGHT_ONE - total;
+}
+
+static void build_table(upscale_table_t *table, float (*kernel)(float))
+{
+    for (int x = 0; x < UPSCALE_DST_W; x++) build_taps(&table->x[x], x, UPSCALE_SRC_W, UPSCALE_DST_W, kernel);
+    for (int y = 0; y < UPSCALE_DST_H; y++) build_taps(&table->y[y], y, UPSCALE_SRC_H, UPSCALE_DST_H, kernel);
+}
+
+void upscale_init(void)
+{
+    build_table(&bicubic_table, kernel_bicubic);
+    build_table(&lanczos2_table, kernel_lanczos2);
+
+    for (int x = 0; x < UPSCALE_DST_W; x++)
+    {
+        int pos = x * (UPSCALE_SRC_W - 1) * WEIGHT_ONE / (UPSCALE_DST_W - 1);
+        edge_base_x[x] = pos / WEIGHT_ONE;
+        edge_frac_x[x] = pos % WEIGHT_ONE;
+    }
+    for (int y = 0; y < UPSCALE_DST_H; y++)
+    {
+        int pos = y * (UPSCALE_SRC_H - 1) * WEIGHT_ONE / (UPSCALE_DST_H - 1);
+        edge_base_y[y] = pos / WEIGHT_ONE;
+        edge_frac_y[y] = pos % WEIGHT_ONE;
+    }
+    for (int f = 0; f <= WEIGHT_ONE; f++)
+    {
+        float t = (float)f / WEIGHT_ONE;
+        t = t * t * (3.0f - 2.0f * t);
+        t = t * t * (3.0f - 2.0f * t);
+        edge_sharpen[f] = (uint8_t)(t * 255.0f + 0.5f);
+    }
+}
+
+static inline uint8_t clamp_index(int32_t v)
+{
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+// 可分离卷积：先横向到 rows（Q8），再纵向并查表
+static void upscale_separable(const upscale_table_t *table, const uint8_t *src, const uint16_t *lut, int16_t *rows, uint16_t *dst)
+{
+    for (int y = 0; y < UPSCALE_SRC_H; y++)
+    {
+        const uint8_t *line = &src[y * UPSCALE_SRC_W];
+        int16_t *out = &rows[y * UPSCALE_DST_W];
+        for (int x = 0; x < UPSCALE_DST_W; x++)
+        {
+            const upscale_taps_t *t = &table->x[x];
+            int32_t v = line[t->index[0]] * t->weight[0] + line[t->index[1]] * t->weight[1] +
+                        line[t->index[2]] * t->weight[2] + line[t->index[3]] * t->weight[3];
+            // Q8 中间结果保留过冲，缩到 Q0+3 位防溢出
+            out[x] = (int16_t)(v >> 5);
+        }
+    }
+    for (int y = 0; y < UPSCALE_DST_H; y++)
+    {
+        const upscale_taps_t *t = &table->y[y];
+        const int16_t *r0 = &rows[t->index[0] * UPSCALE_DST_W];
+        const int16_t *r1 = &rows[t->index[1] * UPSCALE_DST_W];
+        const int16_t *r2 = &rows[t->index[2] * UPSCALE_DST_W];
+        const int16_t *r3 = &rows[t->index[3] * UPSCALE_DST_W];
+        uint16_t *out = &dst[y * UPSCALE_DST_W];
+        for (int x = 0; x < UPSCALE_DST_W; x++)
+        {
+            int32_t v = r0[x] * t->weight[0] + r1[x] * t->weight[1] + r2[x] * t->weight[2] + r3[x] * t->weight[3];
+            out[x] = lut[clamp_index((v + (1 << 10)) >> 11)];
+        }
+    }
+}
+
+// 格内横向/纵向梯度差别明显时，跨边缘方向用陡峭曲线，沿边缘方向保持线性
+static void upscale_edge_directed(const uint8_t *src, const uint16_t *lut, uint16_t *dst)
+{
+    for (int y = 0; y < UPSCALE_DST_H; y++)
+    {
+        int y1 = edge_base_y[y];
+        int y2 = y1 + 1 < UPSCALE_SRC_H ? y1 + 1 : y1;
+        int fy = edge_frac_y[y];
+        for (int x = 0; x < UPSCALE_DST_W; x++)
+        {
+            int x1 = edge_base_x[x];
+            int x2 = x1 + 1 < UPSCALE_SRC_W ? x1 + 1 : x1;
+            int fx = edge_frac_x[x];
+            int q11 = src[y1 * UPSCALE_SRC_W + x1];
+            int q21 = src[y1 * UPSCALE_SRC_W + x2];
+            int q12 = src[y2 * UPSCALE_SRC_W + x1];
+            int q22 = src[y2 * UPSCALE_SRC_W + x2];
+            int gx = abs(q11 - q21) + abs(q12 - q22);
+            int gy = abs(q11 - q12) + abs(q21 - q22);
+
+            if (gx > 2 * gy) fx = edge_sharpen[fx];
+            else if (gy > 2 * gx) fy = edge_sharpen[fy];
+
+            int top = q11 * (WEIGHT_ONE - fx) + q21 * fx;
+            int bottom = q12 * (WEIGHT_ONE - fx) + q22 * fx;
+            int v = (top * (WEIGHT_ONE - fy) + bottom * fy + (1 << 15)) >> 16;
+            dst[y * UPSCALE_DST_W + x] = lut[v];
+        }
+    }
+}
+
+void upscale_to_rgb565(upscale_kernel_t kernel, const uint8_t *src, const uint16_t *lut, int16_t *rows, uint16_t *dst)
+{
+    switch (kernel)
+    {
+        case UPSCALE_LANCZOS2:
+            upscale_separable(&lanczos2_table, src, lut, rows, dst);
+            break;
+        case UPSCALE_EDGE_DIRECTED:
+            upscale_edge_directed(src, lut, dst);
+            break;
+        case UPSCALE_BICUBIC:
+        default:
+            upscale_separable(&bicubic_table, src, lut, rows, dst);
+            break;
+    }
+}
+
+// 清晰度指标：相邻像素 RGB565 绿色分量差的绝对值之和，越大边缘越锐
+uint32_t upscale_sharpness(const uint16_t *img)
+{
+    uint32_t sum = 0;
+    for (int y = 0; y < UPSCALE_DST_H - 1; y++)
+    {
+        for (int x = 0; x < UPSCALE_DST_W - 1; x++)
+        {
+            int g = (img[y * UPSCALE_DST_W + x] >> 5) & 0x3F;
+            int gr = (img[y * UPSCALE_DST_W + x + 1] >> 5) & 0x3F;
+            int gd = (img[(y + 1) * UPSCALE_DST_W + x] >> 5) & 0x3F;
+            sum += abs(g - gr) + abs(g - gd);
+        }
+    }
+    return sum;
+}
+
+void bilinear_scale(const uint16_t *src, uint16_t *dst, int srcW, int srcH, int dstW, int dstH) {
+    float scaleX = (float)(srcW - 1) / (dstW - 1);
+    float scaleY = (float)(srcH - 1) / (dstH - 1);
+
+    for (int y = 0; y < dstH; y++) {
+        for (int x = 0; x < dstW; x++) {
+            float srcX = x * scaleX;
+            float srcY = y * scaleY;
+
+            int x1 = (int)srcX;
+            int y1 = (int)srcY;
+            int x2 = (x1 + 1 >= srcW) ? srcW - 1 : x1 + 1;
+            int y2 = (y1 + 1 >= srcH) ? srcH - 1 : y1 + 1;
+
+            float dx = srcX - x1;
+            float dy = srcY - y1;
+
+            uint16_t Q11 = src[y1 * srcW + x1];
+            uint16_t Q21 = src[y1 * srcW + x2];
+            uint16_t Q12 = src[y2 * srcW + x1];
+            uint16_t Q22 = src[y2 * srcW + x2];
+
+            // 提取 RGB565 分量
+            float r1 = (Q11 >> 11) & 0x1F;
+            float g1 = (Q11 >> 5)  & 0x3F;
+            float b1 = Q11         & 0x1F;
+
+            float r2 = (Q21 >> 11) & 0x1F;
+            float g2 = (Q21 >> 5)  & 0x3F;
+            float b2 = Q21         & 0x1F;
+
+            float r3 = (Q12 >> 11) & 0x1F;
+            float g3 = (Q12 >> 5)  & 0x3F;
+            float b3 = Q12         & 0x1F;
+
+            float r4 = (Q22 >> 11) & 0x1F;
+            float g4 = (Q22 >> 5)  & 0x3F;
+            float b4 = Q22         & 0x1F;
+
+            // 水平插值（上方）
+            float topR = (1 - dx) * r1 + dx * r2;
+            float topG = (1 - dx) * g1 + dx * g2;
+            float topB = (1 - dx) * b1 + dx * b2;
+
+            // 水平插值（下方）
+            float bottomR = (1 - dx) * r3 + dx * r4;
+            float bottomG = (1 - dx) * g3 + dx * g4;
+            float bottomB = (1 - dx) * b3 + dx * b4;
+
+            // 垂直插值
+            float R = (1 - dy) * topR + dy * bottomR;
+            float G = (1 - dy) * topG + dy * bottomG;
+            float B = (1 - dy) * topB + dy * bottomB;
+
+            // 合并成 RGB565
+            dst[y * dstW + x] = ((uint16_t)(R) << 11) | ((uint16_t)(G) << 5) | (uint16_t)(B);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+// 主机端采集调度仿真：在 MLX90640 寄存器模型上比较几种取帧策略的总线占用和延迟
+//
+// 编译：
+//   cc -O2 -I. -o acquisition_sim tools/acquisition_sim.c tools/mlx90640_emulator.c src/MLX90640_API.c -lm
+// 用法：
+//   acquisition_sim [--seconds N] [--rate R] [--freq HZ] [eeprom.bin frames.bin]
+//     --rate R        MLX90640_SetRefreshRate 的刷新率码，默认 4（8Hz）
+//     --freq HZ       I2C 频率，默认 1000000，与固件一致
+//     eeprom.bin/frames.bin 为 recorder_decode 的输出，用于回放场景；不给时使用合成场景
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+#include "include/MLX90640_I2C_Driver.h"
+#include "tools/mlx90640_emulator.h"
+
+#define SLAVE_ADDR 0x33
+#define POLL_SLEEP_US 1000
+#define SCHEDULE_MARGIN_US 2000
+
+typedef struct
+{
+    const char *name;
+    void (*run)(uint64_t end_ns);
+    int interleaved;
+} strategy_t;
+
+static uint16_t eeData[832];
+static uint16_t frameData[MLX90640_EMULATOR_FRAME_WORDS];
+static uint32_t errors;
+
+static void get_frame(void)
+{
+    if (MLX90640_GetFrameData(SLAVE_ADDR, frameData) < 0) errors++;
+}
+
+// 固件当前做法：触发一次测量后连续读两个子页
+static void run_trigger_double(uint64_t end_ns)
+{
+    while (mlx90640_emulator_now_ns() < end_ns)
+    {
+        if (MLX90640_TriggerMeasurement(SLAVE_ADDR) < 0) errors++;
+        get_frame();
+        get_frame();
+    }
+}
+
+// 不触发，GetFrameData 内部忙等数据就绪
+static void run_busy_poll(uint64_t end_ns)
+{
+    while (mlx90640_emulator_now_ns() < end_ns) get_frame();
+}
+
+// 固定间隔读状态寄存器，就绪才取帧
+static void run_sleep_poll(uint64_t end_ns)
+{
+    uint16_t status;
+    while (mlx90640_emulator_now_ns() < end_ns)
+    {
+        MLX90640_I2CRead(SLAVE_ADDR, 0x8000, 1, &status);
+        if (status & 0x0008) get_frame();
+        else mlx90640_emulator_sleep_us(POLL_SLEEP_US);
+    }
+}
+
+// 隔行模式下只读当前子页的行，调度同 trigger_double
+static void run_interleaved_partial(uint64_t end_ns)
+{
+    while (mlx90640_emulator_now_ns() < end_ns)
+    {
+        if (MLX90640_TriggerMeasurement(SLAVE_ADDR) < 0) errors++;
+        if (MLX90640_GetSubpageData(SLAVE_ADDR, frameData) < 0) errors++;
+        if (MLX90640_GetSubpageData(SLAVE_ADDR, frameData) < 0) errors++;
+    }
+}
+
+// 按子页周期绝对定时（同 vTaskDelayUntil），在预计就绪前一点醒来再忙等
+static void run_scheduled(uint64_t end_ns)
+{
+    uint64_t period = mlx90640_emulator_subpage_period_ns();
+    uint64_t wake;
+    uint16_t status = 0;
+
+    // 先轮询一次就绪沿对齐相位，之后不再依赖读帧耗时
+    while (!(status & 0x0008)) MLX90640_I2CRead(SLAVE_ADDR, 0x8000, 1, &status);
+    wake = mlx90640_emulator_now_ns() + period - SCHEDULE_MARGIN_US * 1000ull;
+    get_frame();
+    while (mlx90640_emulator_now_ns() < end_ns)
+    {
+        uint64_t now = mlx90640_emulator_now_ns();
+        if (wake > now) mlx90640_emulator_sleep_us((uint32_t)((wake - now) / 1000));
+        get_frame();
+        wake += period;
+    }
+}
+
+static const strategy_t strategies[] = {
+    {"trigger_double", run_trigger_double, 0},
+    {"busy_poll", run_busy_poll, 0},
+    {"sleep_poll_1ms", run_sleep_poll, 0},
+    {"scheduled", run_scheduled, 0},
+    {"il_partial", run_interleaved_partial, 1},
+};
+
+static long read_file(const char *path, void **data)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    *data = malloc(size > 0 ? size : 1);
+    if (*data == NULL || fread(*data, 1, size, f) != (size_t)size) size = -1;
+    fclose(f);
+    return size;
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 10;
+    int rate = 4;
+    int freq = 1000000;
+    const char *files[2] = {NULL, NULL};
+    int nfiles = 0;
+    uint16_t (*frames)[MLX90640_EMULATOR_FRAME_WORDS] = NULL;
+    long frame_count = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) rate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--freq") == 0 && i + 1 < argc) freq = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && nfiles < 2) files[nfiles++] = argv[i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--seconds N] [--rate R] [--freq HZ] [eeprom.bin frames.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (nfiles == 2)
+    {
+        void *ee, *fr;
+        if (read_file(files[0], &ee) != sizeof(eeData))
+        {
+            fprintf(stderr, "%s: expected %zu bytes of EEPROM\n", files[0], sizeof(eeData));
+            return 1;
+        }
+        memcpy(eeData, ee, sizeof(eeData));
+        free(ee);
+        // frames.bin 每帧为 recorder_frame_t 头加 834 个字
+        long size = read_file(files[1], &fr);
+        long stride = 12 + MLX90640_EMULATOR_FRAME_WORDS * 2;
+        if (size < stride)
+        {
+            fprintf(stderr, "%s: no frames\n", files[1]);
+            return 1;
+        }
+        frame_count = size / stride;
+        frames = malloc(frame_count * sizeof(*frames));
+        for (long i = 0; i < frame_count; i++)
+        {
+            memcpy(frames[i], (uint8_t *)fr + i * stride + 12, sizeof(*frames));
+        }
+        free(fr);
+    }
+
+    printf("%-16s %8s %8s %8s %10s %10s %10s %8s %10s %10s %6s\n", "strategy", "subpg/s", "missed", "bus%",
+           "polls/sp", "bytes/sp", "read B/sp", "xfers/sp", "lat avg us", "lat max us", "errors");
+    for (size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++)
+    {
+        mlx90640_emulator_init(nfiles == 2 ? eeData : NULL);
+        if (frame_count > 0) mlx90640_emulator_replay((const uint16_t (*)[MLX90640_EMULATOR_FRAME_WORDS])frames, frame_count);
+        // 与固件 main() 的初始化顺序一致
+        MLX90640_I2CInit();
+        MLX90640_I2CGeneralReset();
+        if (strategies[s].interleaved) MLX90640_SetInterleavedMode(SLAVE_ADDR);
+        else MLX90640_SetChessMode(SLAVE_ADDR);
+        MLX90640_SetRefreshRate(SLAVE_ADDR, rate);
+        MLX90640_SetResolution(SLAVE_ADDR, 3);
+        MLX90640_I2CFreqSet(freq);
+        MLX90640_DumpEE(SLAVE_ADDR, eeData);
+        mlx90640_emulator_reset_stats();
+        errors = 0;
+
+        uint64_t start = mlx90640_emulator_now_ns();
+        strategies[s].run(start + (uint64_t)(seconds * 1e9));
+        double elapsed = (mlx90640_emulator_now_ns() - start) / 1e9;
+
+        mlx90640_emulator_stats_t st;
+        mlx90640_emulator_get_stats(&st);
+        double n = st.delivered ? st.delivered : 1;
+        // read B/sp 不计状态轮询（每次 6 字节），即取一个子页本身的流量
+        printf("%-16s %8.2f %8lu %7.1f%% %10.1f %10.0f %10.0f %8.1f %10.0f %10.0f %6lu\n", strategies[s].name,
+               st.delivered / elapsed, (unsigned long)st.overwritten, 100.0 * st.bus_ns / 1e9 / elapsed,
+               st.status_polls / n, st.bytes / n, (st.bytes - st.status_polls * 6.0) / n, st.transactions / n,
+               st.latency_ns_total / n / 1000.0, st.latency_ns_max / 1000.0, (unsigned long)errors);
+    }
+
+    free(frames);
+    return 0;
+}
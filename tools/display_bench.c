@@ -0,0 +1,196 @@
+// 主机端显示开销基准：在 ST7789 命令流模型上逐个调用绘图接口，统计 SPI 传输效率
+//
+// 编译：
+//   cc -O2 -I. -o display_bench tools/display_bench.c tools/st7789_emulator.c
+//      src/driver_st7789.c src/driver_st7789_basic.c
+// 用法：
+//   display_bench [--png DIR] [--clk-peri HZ]
+//     --png DIR       每个用例结束后把面板窗口写成 DIR/<用例>.png
+//     --clk-peri HZ   外设时钟，用于换算 SDK 实际 SPI 频率，默认 125000000
+// 图片类用例会把 GRAM 读回与源图比较，不一致返回 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "include/driver_st7789_basic.h"
+#include "tools/st7789_emulator.h"
+
+#define PANEL_WIDTH ST7789_BASIC_DEFAULT_COLUMN
+#define PANEL_HEIGHT ST7789_BASIC_DEFAULT_ROW
+#define IMAGE_WIDTH 96
+#define IMAGE_HEIGHT 72
+
+typedef struct
+{
+    const char *name;
+    int (*run)(void);
+} bench_case_t;
+
+static uint16_t image[IMAGE_WIDTH * IMAGE_HEIGHT];
+static uint16_t readback[IMAGE_WIDTH * IMAGE_HEIGHT];
+
+static int check_window(uint16_t left, uint16_t top, uint16_t width, uint16_t height, const uint16_t *expect)
+{
+    if (st7789_emulator_read_window(ST7789_COLUMN_OFFSET + left, ST7789_ROW_OFFSET + top, width, height, readback) != 0) return 1;
+    return memcmp(readback, expect, (size_t)width * height * sizeof(uint16_t)) != 0;
+}
+
+static int case_init(void)
+{
+    return st7789_basic_init() != 0;
+}
+
+static int case_clear(void)
+{
+    return st7789_basic_clear() != 0;
+}
+
+static int case_point(void)
+{
+    return st7789_basic_write_point(10, 10, RED) != 0;
+}
+
+static int case_rect(void)
+{
+    return st7789_basic_rect(20, 20, 119, 69, BLUE) != 0;
+}
+
+static int case_string_12(void)
+{
+    char str[] = "GetFrame:  1234us";
+    return st7789_basic_string(130, 0, str, strlen(str), BLACK, ST7789_FONT_12) != 0;
+}
+
+static int case_string_16(void)
+{
+    char str[] = "GetFrame:  1234us";
+    return st7789_basic_string(0, 90, str, strlen(str), BLACK, ST7789_FONT_16) != 0;
+}
+
+static int case_string_24(void)
+{
+    char str[] = "36.5C";
+    return st7789_basic_string(0, 108, str, strlen(str), RED, ST7789_FONT_24) != 0;
+}
+
+static int case_colour_bar(void)
+{
+    if (st7789_basic_draw_picture_16bits(118, 0, 127, 71, image) != 0) return 1;
+    return check_window(118, 0, 10, 72, image);
+}
+
+static int case_image(void)
+{
+    if (st7789_basic_draw_picture_16bits(0, 0, IMAGE_WIDTH - 1, IMAGE_HEIGHT - 1, image) != 0) return 1;
+    return check_window(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT, image);
+}
+
+// 与 main_task 每帧的绘制内容一致：热图加 11 行 12 号字和两个 ROI 标记
+static int case_ui_frame(void)
+{
+    static const struct { uint16_t x, y; uint32_t color; const char *fmt; } lines[] = {
+        {130, 0, BLACK, "battery:%4.2fV"}, {130, 12, BLACK, "GetFrame:%7ldus"},
+        {130, 24, BLACK, "CalTemp:%8ldus"}, {130, 36, BLACK, "BadPixelFix:%4ldus"},
+        {130, 60, BLACK, "PixCheck:%7ldus"}, {130, 72, BLACK, "Filter:%9ldus"},
+        {130, 48, BLACK, "DrawImage:%6ldus"}, {0, 72, ORANGE, "AmbientTemp:%4.1f"},
+        {130, 84, BLACK, "ROI:%12ldus"}, {0, 96, ORANGE, "R0 %5.1f/%5.1f/%5.1f sd%4.2f"},
+        {0, 108, ORANGE, "R1 %5.1f/%5.1f/%5.1f sd%4.2f"},
+    };
+    char str[32];
+
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+    {
+        if (strstr(lines[i].fmt, "ld") != NULL) snprintf(str, sizeof(str), lines[i].fmt, 12345L);
+        else if (lines[i].fmt[0] == 'R') snprintf(str, sizeof(str), lines[i].fmt, 3.7, 3.7, 3.7, 3.7);
+        else snprintf(str, sizeof(str), lines[i].fmt, 3.7);
+        if (st7789_basic_string(lines[i].x, lines[i].y, str, strlen(str), lines[i].color, ST7789_FONT_12) != 0) return 1;
+        if (i == 6 && st7789_basic_draw_picture_16bits(0, 0, IMAGE_WIDTH - 1, IMAGE_HEIGHT - 1, image) != 0) return 1;
+    }
+    // 最高/最低温十字标记，各一横一竖
+    for (int m = 0; m < 2; m++)
+    {
+        if (st7789_basic_rect(40 + 20 * m, 30, 44 + 20 * m, 31, m ? BLACK : WHITE) != 0) return 1;
+        if (st7789_basic_rect(42 + 20 * m, 28, 43 + 20 * m, 32, m ? BLACK : WHITE) != 0) return 1;
+    }
+    return 0;
+}
+
+static const bench_case_t cases[] = {
+    {"init", case_init},
+    {"clear", case_clear},
+    {"point", case_point},
+    {"rect_100x50", case_rect},
+    {"string_12", case_string_12},
+    {"string_16", case_string_16},
+    {"string_24", case_string_24},
+    {"colour_bar", case_colour_bar},
+    {"image_96x72", case_image},
+    {"ui_frame", case_ui_frame},
+};
+
+int main(int argc, char **argv)
+{
+    const char *png_dir = NULL;
+    uint32_t clk_peri = ST7789_EMULATOR_CLK_PERI_HZ;
+    int failed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--png") == 0 && i + 1 < argc) png_dir = argv[++i];
+        else if (strcmp(argv[i], "--clk-peri") == 0 && i + 1 < argc) clk_peri = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: %s [--png DIR] [--clk-peri HZ]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // 与 draw_thermal_image 尺寸相同的渐变测试图
+    for (int y = 0; y < IMAGE_HEIGHT; y++)
+    {
+        for (int x = 0; x < IMAGE_WIDTH; x++)
+        {
+            image[y * IMAGE_WIDTH + x] = RGB_TO_565(x * 255 / (IMAGE_WIDTH - 1), y * 255 / (IMAGE_HEIGHT - 1), 128);
+        }
+    }
+
+    uint32_t spi_hz = st7789_emulator_spi_baudrate(clk_peri, ST7789_EMULATOR_SPI_HZ);
+    printf("spi: requested %u Hz, clk_peri %lu Hz gives %u Hz\n",
+           ST7789_EMULATOR_SPI_HZ, (unsigned long)clk_peri, spi_hz);
+    printf("%-12s %6s %6s %6s %8s %8s %7s %6s %9s %9s %6s\n", "case", "xfers", "cs", "dc", "cmd B", "data B",
+           "pixels", "eff%", "60MHz us", "real us", "check");
+
+    st7789_emulator_init();
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        st7789_emulator_stats_t st;
+        int bad;
+
+        st7789_emulator_reset_stats();
+        bad = cases[c].run();
+        st7789_emulator_get_stats(&st);
+        failed |= bad;
+
+        // 有效率：像素负载字节占线上总字节的比例
+        uint64_t total = st.cmd_bytes + st.data_bytes;
+        printf("%-12s %6lu %6lu %6lu %8llu %8llu %7llu %5.1f%% %9.1f %9.1f %6s\n", cases[c].name,
+               (unsigned long)st.transactions, (unsigned long)st.cs_toggles, (unsigned long)st.dc_flips,
+               (unsigned long long)st.cmd_bytes, (unsigned long long)st.data_bytes, (unsigned long long)st.pixels,
+               total ? 100.0 * (st.pixels * 2) / total : 0.0,
+               st7789_emulator_wire_ns(&st, ST7789_EMULATOR_SPI_HZ) / 1000.0,
+               st7789_emulator_wire_ns(&st, spi_hz) / 1000.0, bad ? "FAIL" : "ok");
+
+        if (png_dir != NULL)
+        {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s.png", png_dir, cases[c].name);
+            if (st7789_emulator_dump_png(path, ST7789_COLUMN_OFFSET, ST7789_ROW_OFFSET, PANEL_WIDTH, PANEL_HEIGHT) != 0)
+            {
+                fprintf(stderr, "%s: write failed\n", path);
+                failed = 1;
+            }
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,192 @@
+// 主机端原始帧编解码工具，与固件共用 src/frame_codec.c
+//
+// 编译：
+//   cc -O2 -I. -o frame_codec_tool tools/frame_codec_tool.c src/frame_codec.c
+// 用法（frames.bin 为 recorder_decode 输出的 out_s<N>_frames.bin）：
+//   frame_codec_tool encode frames.bin packed.bin [mode]   压缩，mode 默认 4（rice-temporal）
+//   frame_codec_tool decode packed.bin frames.bin          解压
+//   frame_codec_tool bench frames.bin                      各模式压缩率和每帧耗时
+// packed.bin 逐帧为 recorder_frame_t + recorder_record_header_t + 编码数据，
+// 时间预测模式下每个文件的第一帧用对应的空间模式
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "include/recorder_format.h"
+#include "include/frame_codec.h"
+
+typedef struct
+{
+    recorder_frame_t info;
+    uint16_t frameData[RECORDER_FRAME_WORDS];
+} frame_record_t;
+
+static const char *const mode_names[FRAME_CODEC_MODE_NUM] = {"raw", "spatial", "temporal", "rice-spatial", "rice-temporal"};
+
+static frame_codec_mode_t first_frame_mode(frame_codec_mode_t mode)
+{
+    if (mode == FRAME_CODEC_TEMPORAL) return FRAME_CODEC_SPATIAL;
+    if (mode == FRAME_CODEC_RICE_TEMPORAL) return FRAME_CODEC_RICE_SPATIAL;
+    return mode;
+}
+
+static frame_record_t *load_frames(const char *path, long *count)
+{
+    FILE *f = fopen(path, "rb");
+    frame_record_t *frames;
+    long size;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    *count = size / sizeof(frame_record_t);
+    frames = malloc(*count * sizeof(frame_record_t) + 1);
+    if (frames == NULL || fread(frames, sizeof(frame_record_t), *count, f) != (size_t)*count)
+    {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(f);
+        free(frames);
+        return NULL;
+    }
+    fclose(f);
+    return frames;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int encode_file(const char *in, const char *out, frame_codec_mode_t mode)
+{
+    uint8_t encoded[FRAME_CODEC_MAX_BYTES(RECORDER_FRAME_WORDS)];
+    long count;
+    frame_record_t *frames = load_frames(in, &count);
+    FILE *f;
+
+    if (frames == NULL) return 1;
+    f = fopen(out, "wb");
+    if (f == NULL)
+    {
+        perror(out);
+        free(frames);
+        return 1;
+    }
+    for (long i = 0; i < count; i++)
+    {
+        frame_codec_mode_t m = i == 0 ? first_frame_mode(mode) : mode;
+        const uint16_t *reference = i == 0 ? NULL : frames[i - 1].frameData;
+        int size = frame_codec_encode(m, frames[i].frameData, reference, RECORDER_FRAME_WORDS, encoded);
+        recorder_record_header_t record = {RECORDER_RECORD_FRAME, m, size};
+
+        fwrite(&frames[i].info, sizeof(frames[i].info), 1, f);
+        fwrite(&record, sizeof(record), 1, f);
+        fwrite(encoded, 1, size, f);
+    }
+    fclose(f);
+    free(frames);
+    return 0;
+}
+
+static int decode_file(const char *in, const char *out)
+{
+    uint8_t encoded[FRAME_CODEC_MAX_BYTES(RECORDER_FRAME_WORDS)];
+    frame_record_t frame;
+    uint16_t reference[RECORDER_FRAME_WORDS];
+    recorder_record_header_t record;
+    FILE *fin = fopen(in, "rb");
+    FILE *fout = fopen(out, "wb");
+    long count = 0;
+
+    if (fin == NULL || fout == NULL)
+    {
+        perror(fin == NULL ? in : out);
+        return 1;
+    }
+    while (fread(&frame.info, sizeof(frame.info), 1, fin) == 1)
+    {
+        if (fread(&record, sizeof(record), 1, fin) != 1 || record.length > sizeof(encoded) ||
+            fread(encoded, 1, record.length, fin) != record.length ||
+            frame_codec_decode(record.encoding, encoded, record.length, reference, RECORDER_FRAME_WORDS, frame.frameData) < 0)
+        {
+            fprintf(stderr, "%s: corrupt frame %ld\n", in, count);
+            break;
+        }
+        fwrite(&frame, sizeof(frame), 1, fout);
+        memcpy(reference, frame.frameData, sizeof(reference));
+        count++;
+    }
+    fclose(fin);
+    fclose(fout);
+    printf("%ld frames\n", count);
+    return 0;
+}
+
+static int bench_file(const char *in)
+{
+    uint8_t encoded[FRAME_CODEC_MAX_BYTES(RECORDER_FRAME_WORDS)];
+    uint16_t decoded[RECORDER_FRAME_WORDS];
+    long count;
+    frame_record_t *frames = load_frames(in, &count);
+    int failed = 0;
+
+    if (frames == NULL) return 1;
+    printf("%-14s %8s %12s %12s\n", "mode", "ratio", "encode ns", "decode ns");
+    for (int mode = 0; mode < FRAME_CODEC_MODE_NUM; mode++)
+    {
+        double encode_ns = 0;
+        double decode_ns = 0;
+        long bytes = 0;
+
+        for (long i = 0; i < count; i++)
+        {
+            frame_codec_mode_t m = i == 0 ? first_frame_mode(mode) : (frame_codec_mode_t)mode;
+            const uint16_t *reference = i == 0 ? NULL : frames[i - 1].frameData;
+            double t0 = now_ns();
+            int size = frame_codec_encode(m, frames[i].frameData, reference, RECORDER_FRAME_WORDS, encoded);
+            double t1 = now_ns();
+            int used = frame_codec_decode(m, encoded, size, reference, RECORDER_FRAME_WORDS, decoded);
+            double t2 = now_ns();
+
+            if (used != size || memcmp(decoded, frames[i].frameData, sizeof(decoded)) != 0)
+            {
+                fprintf(stderr, "%s: frame %ld does not round-trip\n", mode_names[mode], i);
+                failed = 1;
+            }
+            encode_ns += t1 - t0;
+            decode_ns += t2 - t1;
+            bytes += size;
+        }
+        printf("%-14s %8.2f %12.0f %12.0f\n", mode_names[mode],
+               bytes ? (double)count * RECORDER_FRAME_WORDS * 2 / bytes : 0.0,
+               count ? encode_ns / count : 0.0, count ? decode_ns / count : 0.0);
+    }
+    free(frames);
+    return failed;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 4 && strcmp(argv[1], "encode") == 0)
+    {
+        frame_codec_mode_t mode = argc >= 5 ? (frame_codec_mode_t)atoi(argv[4]) : FRAME_CODEC_RICE_TEMPORAL;
+        if (mode >= FRAME_CODEC_MODE_NUM)
+        {
+            fprintf(stderr, "mode must be 0..%d\n", FRAME_CODEC_MODE_NUM - 1);
+            return 1;
+        }
+        return encode_file(argv[2], argv[3], mode);
+    }
+    if (argc >= 4 && strcmp(argv[1], "decode") == 0) return decode_file(argv[2], argv[3]);
+    if (argc >= 3 && strcmp(argv[1], "bench") == 0) return bench_file(argv[2]);
+
+    fprintf(stderr, "usage: %s encode <frames> <packed> [mode] | decode <packed> <frames> | bench <frames>\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,268 @@
+#include <math.h>
+#include <string.h>
+#include "include/MLX90640_I2C_Driver.h"
+#include "tools/mlx90640_emulator.h"
+
+#define EMU_EEPROM_START 0x2400
+#define EMU_EEPROM_WORDS 832
+#define EMU_RAM_START 0x0400
+#define EMU_RAM_WORDS (768 + 64)
+#define EMU_STATUS_REG 0x8000
+#define EMU_CTRL_REG 0x800D
+
+#define EMU_STATUS_SUBPAGE 0x0007
+#define EMU_STATUS_READY 0x0008
+#define EMU_STATUS_WRITABLE 0x0030
+#define EMU_STATUS_START 0x0020
+#define EMU_CTRL_STEP_MODE 0x0002
+#define EMU_CTRL_SUBPAGE_REPEAT 0x0008
+#define EMU_CTRL_TRIGGER 0x8000
+
+#define I2C_BITS_PER_BYTE 9
+
+typedef struct
+{
+    uint16_t eeprom[EMU_EEPROM_WORDS];
+    uint16_t ram[EMU_RAM_WORDS];
+    uint16_t status;
+    uint16_t ctrl;
+    uint32_t freq;
+    uint32_t overhead_ns;
+    uint64_t now_ns;
+    uint64_t next_ns;           // 下一个子页完成时刻，UINT64_MAX 表示步进模式下等待触发
+    uint64_t ready_ns;
+    uint32_t index;
+    int last_subpage;
+    mlx90640_emulator_scene_t scene;
+    void *scene_ctx;
+    const uint16_t (*replay)[MLX90640_EMULATOR_FRAME_WORDS];
+    long replay_count;
+    uint16_t frame[MLX90640_EMULATOR_FRAME_WORDS];
+    mlx90640_emulator_stats_t stats;
+} emulator_t;
+
+static emulator_t emu;
+
+// 刷新率码 0~7 对应 0.5~64Hz，每个子页一个周期
+uint64_t mlx90640_emulator_subpage_period_ns(void)
+{
+    int rate = (emu.ctrl >> 7) & 7;
+    return 2000000000ull >> rate;
+}
+
+static uint32_t lcg_state = 1;
+
+static uint32_t lcg(void)
+{
+    lcg_state = lcg_state * 1103515245 + 12345;
+    return lcg_state >> 8;
+}
+
+// 默认场景：均匀背景上一个沿圆周移动的热点，辅助数据取固定的合法值
+static void synthetic_scene(void *ctx, uint32_t index, int subPage, uint16_t *frameData)
+{
+    (void)ctx;
+    (void)subPage;
+    int cx = 16 + (int)(10 * cos(index * 0.1));
+    int cy = 12 + (int)(7 * sin(index * 0.1));
+
+    for (int i = 0; i < 768; i++)
+    {
+        int dx = i % 32 - cx;
+        int dy = i / 32 - cy;
+        int hot = dx * dx + dy * dy < 9 ? 300 : 0;
+        frameData[i] = (uint16_t)(int16_t)(-200 + hot + (int)(lcg() % 5) - 2);
+    }
+    for (int i = 768; i < 832; i++) frameData[i] = 0x0100 + i;
+    frameData[768] = 1500;
+    frameData[776] = (uint16_t)(int16_t)-50;
+    frameData[778] = 0x1380;
+    frameData[800] = 1700;
+    frameData[808] = (uint16_t)(int16_t)-52;
+    frameData[810] = (uint16_t)(int16_t)-13000;
+}
+
+static void replay_scene(void *ctx, uint32_t index, int subPage, uint16_t *frameData)
+{
+    (void)ctx;
+    (void)subPage;
+    memcpy(frameData, emu.replay[index % emu.replay_count], 832 * sizeof(uint16_t));
+}
+
+static int pixel_subpage(int pixel)
+{
+    int il = (pixel / 32) & 1;
+    if (emu.ctrl & 0x1000) return il ^ (pixel & 1);
+    return il;
+}
+
+static void complete_subpage(void)
+{
+    int subPage;
+
+    if (emu.ctrl & EMU_CTRL_SUBPAGE_REPEAT) subPage = (emu.ctrl >> 4) & 1;
+    else subPage = emu.last_subpage ^ 1;
+
+    emu.scene(emu.scene_ctx, emu.index++, subPage, emu.frame);
+    for (int i = 0; i < 768; i++)
+    {
+        if (pixel_subpage(i) == subPage) emu.ram[i] = emu.frame[i];
+    }
+    memcpy(&emu.ram[768], &emu.frame[768], 64 * sizeof(uint16_t));
+
+    if (emu.status & EMU_STATUS_READY) emu.stats.overwritten++;
+    emu.status = (emu.status & ~EMU_STATUS_SUBPAGE) | subPage | EMU_STATUS_READY;
+    emu.last_subpage = subPage;
+    emu.ready_ns = emu.next_ns;
+    emu.stats.subpages++;
+}
+
+static void schedule(void)
+{
+    emu.next_ns = emu.now_ns + mlx90640_emulator_subpage_period_ns();
+}
+
+static void advance(uint64_t ns)
+{
+    emu.now_ns += ns;
+    while (emu.now_ns >= emu.next_ns)
+    {
+        complete_subpage();
+        if (emu.ctrl & EMU_CTRL_STEP_MODE) emu.next_ns = UINT64_MAX;
+        else emu.next_ns += mlx90640_emulator_subpage_period_ns();
+    }
+}
+
+static void bus_transfer(uint32_t bytes)
+{
+    uint64_t ns = (uint64_t)bytes * I2C_BITS_PER_BYTE * 1000000000ull / emu.freq + emu.overhead_ns;
+    emu.stats.transactions++;
+    emu.stats.bytes += bytes;
+    emu.stats.bus_ns += ns;
+    advance(ns);
+}
+
+static uint16_t read_word(uint16_t address)
+{
+    if (address >= EMU_EEPROM_START && address < EMU_EEPROM_START + EMU_EEPROM_WORDS) return emu.eeprom[address - EMU_EEPROM_START];
+    if (address >= EMU_RAM_START && address < EMU_RAM_START + EMU_RAM_WORDS) return emu.ram[address - EMU_RAM_START];
+    if (address == EMU_STATUS_REG) return emu.status;
+    if (address == EMU_CTRL_REG) return emu.ctrl;
+    return 0;
+}
+
+void mlx90640_emulator_init(const uint16_t *eeData)
+{
+    memset(&emu, 0, sizeof(emu));
+    if (eeData != NULL) memcpy(emu.eeprom, eeData, sizeof(emu.eeprom));
+    emu.eeprom[0x0D] = MLX90640_EMULATOR_DEFAULT_CTRL;
+    emu.ctrl = MLX90640_EMULATOR_DEFAULT_CTRL;
+    emu.freq = MLX90640_EMULATOR_DEFAULT_FREQ;
+    emu.overhead_ns = MLX90640_EMULATOR_DEFAULT_OVERHEAD_NS;
+    emu.last_subpage = 1;
+    emu.scene = synthetic_scene;
+    for (int i = 0; i < EMU_RAM_WORDS; i++) emu.ram[i] = 0x7FFF;
+    schedule();
+}
+
+void mlx90640_emulator_set_scene(mlx90640_emulator_scene_t scene, void *ctx)
+{
+    emu.scene = scene != NULL ? scene : synthetic_scene;
+    emu.scene_ctx = ctx;
+}
+
+void mlx90640_emulator_replay(const uint16_t (*frames)[MLX90640_EMULATOR_FRAME_WORDS], long count)
+{
+    emu.replay = frames;
+    emu.replay_count = count;
+    mlx90640_emulator_set_scene(count > 0 ? replay_scene : NULL, NULL);
+}
+
+void mlx90640_emulator_set_overhead_ns(uint32_t overhead_ns)
+{
+    emu.overhead_ns = overhead_ns;
+}
+
+uint64_t mlx90640_emulator_now_ns(void)
+{
+    return emu.now_ns;
+}
+
+void mlx90640_emulator_sleep_us(uint32_t us)
+{
+    advance((uint64_t)us * 1000);
+}
+
+void mlx90640_emulator_get_stats(mlx90640_emulator_stats_t *stats)
+{
+    *stats = emu.stats;
+}
+
+void mlx90640_emulator_reset_stats(void)
+{
+    memset(&emu.stats, 0, sizeof(emu.stats));
+}
+
+void MLX90640_I2CInit(void)
+{
+    emu.freq = MLX90640_EMULATOR_DEFAULT_FREQ;
+}
+
+void MLX90640_I2CFreqSet(int freq)
+{
+    emu.freq = freq > 0 ? freq : MLX90640_EMULATOR_DEFAULT_FREQ;
+}
+
+// 通用复位：地址 0x00 + 命令 0x06
+int MLX90640_I2CGeneralReset(void)
+{
+    bus_transfer(2);
+    return 0;
+}
+
+// 读：地址字节 + 2 字节寄存器地址，重复起始后地址字节 + 2n 字节数据
+// 数据在传输结束时刻采样，与读像素 RAM 期间子页更新的实际行为一致
+int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nMemAddressRead, uint16_t *data)
+{
+    (void)slaveAddr;
+    if (startAddress == EMU_STATUS_REG) emu.stats.status_polls++;
+
+    bus_transfer(4 + 2 * nMemAddressRead);
+    for (int i = 0; i < nMemAddressRead; i++)
+    {
+        data[i] = read_word(startAddress + i);
+    }
+    return 0;
+}
+
+int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data)
+{
+    (void)slaveAddr;
+    bus_transfer(5);
+
+    if (writeAddress == EMU_STATUS_REG)
+    {
+        // 数据就绪位写 0 清除并视为主机取走该子页，bit4/bit5 可写，bit5 在步进模式下启动一次测量
+        if ((emu.status & EMU_STATUS_READY) && !(data & EMU_STATUS_READY))
+        {
+            uint64_t latency = emu.now_ns - emu.ready_ns;
+            emu.stats.delivered++;
+            emu.stats.latency_ns_total += latency;
+            if (latency > emu.stats.latency_ns_max) emu.stats.latency_ns_max = latency;
+        }
+        emu.status = (emu.status & ~(EMU_STATUS_WRITABLE | EMU_STATUS_READY)) | (data & (EMU_STATUS_WRITABLE | EMU_STATUS_READY));
+        if ((data & EMU_STATUS_START) && (emu.ctrl & EMU_CTRL_STEP_MODE)) schedule();
+    }
+    else if (writeAddress == EMU_CTRL_REG)
+    {
+        uint16_t old = emu.ctrl;
+        // 触发位在测量开始时由器件清零，读回为 0
+        emu.ctrl = data & ~EMU_CTRL_TRIGGER;
+        if ((data & EMU_CTRL_TRIGGER) || ((old ^ data) & 0x0380)) schedule();
+    }
+    else if (writeAddress >= EMU_EEPROM_START && writeAddress < EMU_EEPROM_START + EMU_EEPROM_WORDS)
+    {
+        emu.eeprom[writeAddress - EMU_EEPROM_START] = data;
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef _MLX90640_EMULATOR_H_
+#define _MLX90640_EMULATOR_H_
+
+#include <stdint.h>
+
+// 主机端 MLX90640 寄存器级行为模型，实现 MLX90640_I2C_Driver.h 的全部接口
+// EEPROM 0x2400、像素 RAM 0x0400、辅助 RAM 0x0700、状态寄存器 0x8000、控制寄存器 0x800D
+// 时间为虚拟时钟：每次 I2C 传输按字节数和总线频率推进，子页按控制寄存器的刷新率在虚拟时间上完成
+#define MLX90640_EMULATOR_FRAME_WORDS 834
+#define MLX90640_EMULATOR_DEFAULT_CTRL 0x1901
+#define MLX90640_EMULATOR_DEFAULT_FREQ 100000
+// 每次传输的软件和起止条件开销
+#define MLX90640_EMULATOR_DEFAULT_OVERHEAD_NS 5000
+
+// 子页完成时调用，填写该时刻的完整帧（像素和辅助数据），模型只取属于该子页的像素
+typedef void (*mlx90640_emulator_scene_t)(void *ctx, uint32_t index, int subPage, uint16_t *frameData);
+
+typedef struct
+{
+    uint32_t transactions;
+    uint64_t bytes;
+    uint64_t bus_ns;            // 总线占用时间
+    uint32_t status_polls;      // 状态寄存器读取次数
+    uint32_t subpages;          // 模型完成的子页数
+    uint32_t overwritten;       // 数据就绪未被读走又被新子页覆盖
+    uint32_t delivered;         // 主机清除数据就绪位的次数，即取走的子页数
+    uint64_t latency_ns_total;  // 数据就绪到主机清除就绪位
+    uint64_t latency_ns_max;
+} mlx90640_emulator_stats_t;
+
+void mlx90640_emulator_init(const uint16_t *eeData);
+void mlx90640_emulator_set_scene(mlx90640_emulator_scene_t scene, void *ctx);
+void mlx90640_emulator_replay(const uint16_t (*frames)[MLX90640_EMULATOR_FRAME_WORDS], long count);
+void mlx90640_emulator_set_overhead_ns(uint32_t overhead_ns);
+uint64_t mlx90640_emulator_now_ns(void);
+void mlx90640_emulator_sleep_us(uint32_t us);
+uint64_t mlx90640_emulator_subpage_period_ns(void);
+void mlx90640_emulator_get_stats(mlx90640_emulator_stats_t *stats);
+void mlx90640_emulator_reset_stats(void);
+
+#endif
@@ -0,0 +1,192 @@
+#include <math.h>
+#include <stddef.h>
+#include "tools/mlx90640_reference.h"
+
+static inline int reference_mode(const uint16_t *frameData)
+{
+    return (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> 5;
+}
+
+static inline double pow2(int x)
+{
+    return ldexp(1.0, x);
+}
+
+double mlx90640_reference_vdd(const uint16_t *frameData, const paramsMLX90640 *params)
+{
+    int resolutionRAM = (frameData[832] & ~MLX90640_CTRL_RESOLUTION_MASK) >> MLX90640_CTRL_RESOLUTION_SHIFT;
+    double resolutionCorrection = pow2(params->resolutionEE) / pow2(resolutionRAM);
+
+    return (resolutionCorrection * (int16_t)frameData[810] - params->vdd25) / params->kVdd + 3.3;
+}
+
+double mlx90640_reference_ta(const uint16_t *frameData, const paramsMLX90640 *params)
+{
+    double vdd = mlx90640_reference_vdd(frameData, params);
+    double ptat = (int16_t)frameData[800];
+    double ptatArt = (ptat / (ptat * params->alphaPTAT + (int16_t)frameData[768])) * pow2(18);
+    double ta = ptatArt / (1 + params->KvPTAT * (vdd - 3.3)) - params->vPTAT25;
+
+    return ta / params->KtPTAT + 25;
+}
+
+// 补偿后的像素 IR 信号，to 和 image 共用；返回 0 表示像素不属于当前子页
+static int reference_ir(const uint16_t *frameData, const paramsMLX90640 *params, int pixel, double ta, double vdd,
+                        const double *irDataCP, double *irData)
+{
+    int mode = reference_mode(frameData);
+    int ilPattern = pixel / 32 - (pixel / 64) * 2;
+    int chessPattern = ilPattern ^ (pixel - (pixel / 2) * 2);
+    int conversionPattern = ((pixel + 2) / 4 - (pixel + 3) / 4 + (pixel + 1) / 4 - pixel / 4) * (1 - 2 * ilPattern);
+    int pattern = mode == 0 ? ilPattern : chessPattern;
+    double gain = (double)params->gainEE / (int16_t)frameData[778];
+    double kta = params->kta[pixel] / pow2(params->ktaScale);
+    double kv = params->kv[pixel] / pow2(params->kvScale);
+
+    if (pattern != frameData[833]) return 0;
+
+    *irData = (int16_t)frameData[pixel] * gain;
+    *irData -= params->offset[pixel] * (1 + kta * (ta - 25)) * (1 + kv * (vdd - 3.3));
+    if (mode != params->calibrationModeEE)
+    {
+        *irData += params->ilChessC[2] * (2 * ilPattern - 1) - params->ilChessC[1] * conversionPattern;
+    }
+    *irData -= params->tgc * irDataCP[frameData[833]];
+    return 1;
+}
+
+static void reference_cp(const uint16_t *frameData, const paramsMLX90640 *params, double ta, double vdd, double *irDataCP)
+{
+    double gain = (double)params->gainEE / (int16_t)frameData[778];
+    double drift = (1 + params->cpKta * (ta - 25)) * (1 + params->cpKv * (vdd - 3.3));
+
+    irDataCP[0] = (int16_t)frameData[776] * gain - params->cpOffset[0] * drift;
+    if (reference_mode(frameData) == params->calibrationModeEE)
+    {
+        irDataCP[1] = (int16_t)frameData[808] * gain - params->cpOffset[1] * drift;
+    }
+    else
+    {
+        irDataCP[1] = (int16_t)frameData[808] * gain - (params->cpOffset[1] + params->ilChessC[0]) * drift;
+    }
+}
+
+// range 可为 NULL，否则写出每个当前子页像素所在的 ct 区间，其余为 -1
+void mlx90640_reference_to(const uint16_t *frameData, const paramsMLX90640 *params, double emissivity, double tr, double *result, int8_t *range)
+{
+    double vdd = mlx90640_reference_vdd(frameData, params);
+    double ta = mlx90640_reference_ta(frameData, params);
+    double ta4 = pow(ta + 273.15, 4);
+    double tr4 = pow(tr + 273.15, 4);
+    double taTr = tr4 - (tr4 - ta4) / emissivity;
+    double alphaCorrR[REFERENCE_CT_RANGES];
+    double irDataCP[2];
+
+    alphaCorrR[0] = 1 / (1 + params->ksTo[0] * 40);
+    alphaCorrR[1] = 1;
+    alphaCorrR[2] = 1 + params->ksTo[1] * params->ct[2];
+    alphaCorrR[3] = alphaCorrR[2] * (1 + params->ksTo[2] * (params->ct[3] - params->ct[2]));
+    reference_cp(frameData, params, ta, vdd, irDataCP);
+
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        double irData;
+        int r;
+
+        if (range != NULL) range[pixel] = -1;
+        if (!reference_ir(frameData, params, pixel, ta, vdd, irDataCP, &irData)) continue;
+
+        irData /= emissivity;
+        double alpha = SCALEALPHA * pow2(params->alphaScale) / params->alpha[pixel];
+        alpha *= 1 + params->KsTa * (ta - 25);
+
+        double Sx = alpha * alpha * alpha * (irData + alpha * taTr);
+        Sx = sqrt(sqrt(Sx)) * params->ksTo[1];
+        double To = sqrt(sqrt(irData / (alpha * (1 - params->ksTo[1] * 273.15) + Sx) + taTr)) - 273.15;
+
+        if (To < params->ct[1]) r = 0;
+        else if (To < params->ct[2]) r = 1;
+        else if (To < params->ct[3]) r = 2;
+        else r = 3;
+
+        result[pixel] = sqrt(sqrt(irData / (alpha * alphaCorrR[r] * (1 + params->ksTo[r] * (To - params->ct[r]))) + taTr)) - 273.15;
+        if (range != NULL) range[pixel] = r;
+    }
+}
+
+void mlx90640_reference_image(const uint16_t *frameData, const paramsMLX90640 *params, double *result)
+{
+    double vdd = mlx90640_reference_vdd(frameData, params);
+    double ta = mlx90640_reference_ta(frameData, params);
+    double irDataCP[2];
+
+    reference_cp(frameData, params, ta, vdd, irDataCP);
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        double irData;
+        if (reference_ir(frameData, params, pixel, ta, vdd, irDataCP, &irData))
+        {
+            result[pixel] = irData * params->alpha[pixel];
+        }
+    }
+}
+
+int mlx90640_reference_compare(const uint16_t *frameData, const paramsMLX90640 *params, double emissivity, double tr,
+                               const float *to, const float *image, float ta, float vdd, mlx90640_reference_error_t *error)
+{
+    static double ref_to[MLX90640_PIXEL_NUM];
+    static double ref_image[MLX90640_PIXEL_NUM];
+    static int8_t range[MLX90640_PIXEL_NUM];
+    int failed = 0;
+
+    mlx90640_reference_to(frameData, params, emissivity, tr, ref_to, range);
+    if (image != NULL) mlx90640_reference_image(frameData, params, ref_image);
+
+    double e = fabs(ta - mlx90640_reference_ta(frameData, params));
+    if (e > error->ta) error->ta = e;
+    failed |= e > REFERENCE_TA_TOLERANCE;
+    e = fabs(vdd - mlx90640_reference_vdd(frameData, params));
+    if (e > error->vdd) error->vdd = e;
+    failed |= e > REFERENCE_VDD_TOLERANCE;
+
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        if (range[pixel] < 0 || !isfinite(ref_to[pixel])) continue;
+        error->pixels++;
+        error->range_pixels[range[pixel]]++;
+
+        e = fabs(to[pixel] - ref_to[pixel]);
+        if (!(e <= REFERENCE_TO_TOLERANCE)) failed = 1;
+        if (e > error->to || e != e) error->to = e;
+
+        if (image != NULL)
+        {
+            // image = IR * alpha，误差折算回 IR 计数
+            e = fabs(image[pixel] - ref_image[pixel]) / fmax(params->alpha[pixel], 1.0);
+            if (!(e <= REFERENCE_IMAGE_TOLERANCE)) failed = 1;
+            if (e > error->image || e != e) error->image = e;
+        }
+    }
+    return failed;
+}
+
+int mlx90640_reference_compare_to(const uint16_t *frameData, const paramsMLX90640 *params, double emissivity, double tr,
+                                  const float *to, double tolerance, mlx90640_reference_error_t *error)
+{
+    static double ref_to[MLX90640_PIXEL_NUM];
+    static int8_t range[MLX90640_PIXEL_NUM];
+    int failed = 0;
+
+    mlx90640_reference_to(frameData, params, emissivity, tr, ref_to, range);
+    for (int pixel = 0; pixel < MLX90640_PIXEL_NUM; pixel++)
+    {
+        if (range[pixel] < 0 || !isfinite(ref_to[pixel])) continue;
+        error->pixels++;
+        error->range_pixels[range[pixel]]++;
+
+        double e = fabs(to[pixel] - ref_to[pixel]);
+        if (!(e <= tolerance)) failed = 1;
+        if (e > error->to || e != e) error->to = e;
+    }
+    return failed;
+}
@@ -0,0 +1,44 @@
+#ifndef _MLX90640_REFERENCE_H_
+#define _MLX90640_REFERENCE_H_
+
+#include <stdint.h>
+#include "include/MLX90640_API.h"
+
+// Melexis 原始算法的双精度参考实现，只用于校验优化后的内核精度，不用于显示路径
+// 公式和分支与 MLX90640_CalculateTo/GetImage/GetTa/GetVdd 一一对应
+#define REFERENCE_TO_TOLERANCE 0.01         // °C
+#define REFERENCE_IMAGE_TOLERANCE 0.05      // IR 计数
+#define REFERENCE_TA_TOLERANCE 0.001        // °C
+#define REFERENCE_VDD_TOLERANCE 1e-5        // V
+#define REFERENCE_TO_CACHED_TOLERANCE 0.02  // °C，偏移补偿缓存按漂移了不到一个量化步长的 Ta/Vdd 建立时
+// 惰性 To 沿用的值按上一次的 Ta/Tr 算出，Tr 跟随 Ta，误差与 Ta 量化步长同量级
+#define REFERENCE_TO_LAZY_DRIFT_TOLERANCE 0.06  // °C，噪声底 0，Ta/Vdd 漂移不到一个量化步长
+#define REFERENCE_TO_LAZY_TOLERANCE 0.5     // °C，再加上原始值相差 4 个计数（合成语料增益约 2）
+#define REFERENCE_TO_CENTI_TOLERANCE 0.015  // °C，To 容差加半个 0.01°C 计数
+
+#define REFERENCE_CT_RANGES 4
+
+typedef struct
+{
+    double to;              // 像素最大绝对误差
+    double image;           // 像素最大误差，折算为 IR 计数
+    double ta;
+    double vdd;
+    uint32_t pixels;
+    uint32_t range_pixels[REFERENCE_CT_RANGES];
+} mlx90640_reference_error_t;
+
+double mlx90640_reference_vdd(const uint16_t *frameData, const paramsMLX90640 *params);
+double mlx90640_reference_ta(const uint16_t *frameData, const paramsMLX90640 *params);
+void mlx90640_reference_to(const uint16_t *frameData, const paramsMLX90640 *params, double emissivity, double tr, double *result, int8_t *range);
+void mlx90640_reference_image(const uint16_t *frameData, const paramsMLX90640 *params, double *result);
+
+// 对当前子页像素比较 to/image 与参考值，累计最大误差；超出容差返回 1
+int mlx90640_reference_compare(const uint16_t *frameData, const paramsMLX90640 *params, double emissivity, double tr,
+                               const float *to, const float *image, float ta, float vdd, mlx90640_reference_error_t *error);
+
+// 只比较 To，容差由调用者给出，用于带近似的快速内核
+int mlx90640_reference_compare_to(const uint16_t *frameData, const paramsMLX90640 *params, double emissivity, double tr,
+                                  const float *to, double tolerance, mlx90640_reference_error_t *error);
+
+#endif
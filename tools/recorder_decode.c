@@ -0,0 +1,148 @@
+// 主机端录制日志解码工具
+//
+// 读出录制区（默认在 flash 末尾 1MB+4KB 处，见 include/recorder.h）：
+//   picotool save -r 0x100FF000 0x101FF000 log.bin
+// 编译：
+//   cc -O2 -I. -o recorder_decode tools/recorder_decode.c src/frame_codec.c
+// 用法：
+//   recorder_decode log.bin out
+// 每个会话输出 out_s<N>_eeprom.bin（recorder_session_t）和
+// out_s<N>_frames.bin（逐帧 recorder_frame_t + frameData[834]，小端）
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/recorder_format.h"
+#include "include/frame_codec.h"
+
+typedef struct
+{
+    uint32_t session;
+    FILE *frames;
+    uint32_t count;
+    uint32_t gaps;
+    uint32_t last_sequence;
+    uint64_t encoded_bytes;
+} session_output_t;
+
+static void session_close(session_output_t *out)
+{
+    if (out->frames == NULL) return;
+    fclose(out->frames);
+    printf("session %u: %u frames, %u sequence gaps, ratio %.2f\n", out->session, out->count, out->gaps,
+           out->encoded_bytes ? (double)out->count * RECORDER_FRAME_WORDS * 2 / out->encoded_bytes : 0.0);
+    out->frames = NULL;
+}
+
+static int session_open(session_output_t *out, const char *prefix, uint32_t session)
+{
+    char path[512];
+
+    session_close(out);
+    memset(out, 0, sizeof(*out));
+    out->session = session;
+    snprintf(path, sizeof(path), "%s_s%u_frames.bin", prefix, session);
+    out->frames = fopen(path, "wb");
+    if (out->frames == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+static void write_session(const char *prefix, uint32_t session, const uint8_t *payload, int length)
+{
+    char path[512];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s_s%u_eeprom.bin", prefix, session);
+    f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        perror(path);
+        return;
+    }
+    fwrite(payload, 1, length, f);
+    fclose(f);
+}
+
+// 解码一个扇区，记录损坏时跳过扇区剩余部分
+static void decode_sector(const uint8_t *sector, const char *prefix, session_output_t *out)
+{
+    const recorder_sector_header_t *header = (const recorder_sector_header_t *)sector;
+    uint16_t reference[RECORDER_FRAME_WORDS];
+    int have_reference = 0;
+    int offset = sizeof(recorder_sector_header_t);
+    int used = header->used <= RECORDER_SECTOR_BYTES ? header->used : RECORDER_SECTOR_BYTES;
+
+    if (out->frames == NULL || out->session != header->session)
+    {
+        if (session_open(out, prefix, header->session) != 0) return;
+    }
+
+    for (int r = 0; r < header->records && offset + (int)sizeof(recorder_record_header_t) <= used; r++)
+    {
+        recorder_record_header_t record;
+        memcpy(&record, &sector[offset], sizeof(record));
+        offset += sizeof(record);
+        if (offset + record.length > used) break;
+        const uint8_t *payload = &sector[offset];
+        offset += record.length;
+
+        if (record.type == RECORDER_RECORD_SESSION)
+        {
+            write_session(prefix, header->session, payload, record.length);
+        }
+        else if (record.type == RECORDER_RECORD_FRAME && record.length >= (int)sizeof(recorder_frame_t))
+        {
+            recorder_frame_t info;
+            uint16_t frame[RECORDER_FRAME_WORDS];
+            int size = record.length - sizeof(info);
+
+            memcpy(&info, payload, sizeof(info));
+            if (record.encoding == FRAME_CODEC_TEMPORAL && !have_reference) break;
+            if (frame_codec_decode(record.encoding, payload + sizeof(info), size, reference, RECORDER_FRAME_WORDS, frame) < 0)
+            {
+                fprintf(stderr, "session %u sector %u: bad frame %u\n", header->session, header->index, info.sequence);
+                break;
+            }
+            if (out->count > 0 && info.sequence != out->last_sequence + 1) out->gaps++;
+            out->last_sequence = info.sequence;
+            out->count++;
+            out->encoded_bytes += size;
+            fwrite(&info, sizeof(info), 1, out->frames);
+            fwrite(frame, sizeof(frame), 1, out->frames);
+            memcpy(reference, frame, sizeof(reference));
+            have_reference = 1;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    uint8_t sector[RECORDER_SECTOR_BYTES];
+    session_output_t out = {0};
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <flash dump> <output prefix>\n", argv[0]);
+        return 1;
+    }
+    f = fopen(argv[1], "rb");
+    if (f == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    while (fread(sector, 1, sizeof(sector), f) == sizeof(sector))
+    {
+        const recorder_sector_header_t *header = (const recorder_sector_header_t *)sector;
+        if (header->magic != RECORDER_SECTOR_MAGIC) break;
+        decode_sector(sector, argv[2], &out);
+    }
+    session_close(&out);
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,400 @@
+#include <stdio.h>
+#include <string.h>
+#include "include/driver_st7789_interface.h"
+#include "tools/st7789_emulator.h"
+
+#define CMD_SWRESET 0x01
+#define CMD_CASET 0x2A
+#define CMD_RASET 0x2B
+#define CMD_RAMWR 0x2C
+#define CMD_MADCTL 0x36
+#define CMD_COLMOD 0x3A
+#define CMD_RAMWRC 0x3C
+
+#define MADCTL_MY 0x80
+#define MADCTL_MX 0x40
+#define MADCTL_MV 0x20
+#define MADCTL_BGR 0x08
+
+typedef struct
+{
+    uint32_t gram[ST7789_EMULATOR_GRAM_ROWS][ST7789_EMULATOR_GRAM_COLUMNS];     // 0x00RRGGBB
+    uint8_t dc;
+    uint8_t cmd;
+    uint8_t params[4];
+    uint8_t param_count;
+    uint8_t madctl;
+    uint8_t colmod;
+    uint16_t xs, xe, ys, ye;
+    uint16_t x, y;
+    uint8_t pending[3];         // 跨传输未凑满一个像素的字节
+    uint8_t pending_count;
+    uint32_t overhead_ns;
+    st7789_emulator_stats_t stats;
+} emulator_t;
+
+static emulator_t emu;
+
+static void logical_size(uint16_t *width, uint16_t *height)
+{
+    *width = (emu.madctl & MADCTL_MV) ? ST7789_EMULATOR_GRAM_ROWS : ST7789_EMULATOR_GRAM_COLUMNS;
+    *height = (emu.madctl & MADCTL_MV) ? ST7789_EMULATOR_GRAM_COLUMNS : ST7789_EMULATOR_GRAM_ROWS;
+}
+
+// 逻辑地址按 MADCTL 映射到物理 GRAM，越界返回 NULL
+static uint32_t *gram_at(uint16_t x, uint16_t y)
+{
+    uint16_t width, height;
+
+    logical_size(&width, &height);
+    if (x >= width || y >= height) return NULL;
+    if (emu.madctl & MADCTL_MX) x = width - 1 - x;
+    if (emu.madctl & MADCTL_MY) y = height - 1 - y;
+    if (emu.madctl & MADCTL_MV) return &emu.gram[x][y];
+    return &emu.gram[y][x];
+}
+
+static void put_pixel(uint8_t r, uint8_t g, uint8_t b)
+{
+    uint32_t *p = gram_at(emu.x, emu.y);
+
+    if (emu.madctl & MADCTL_BGR)
+    {
+        uint8_t t = r;
+        r = b;
+        b = t;
+    }
+    if (p != NULL) *p = ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    emu.stats.pixels++;
+
+    if (++emu.x > emu.xe)
+    {
+        emu.x = emu.xs;
+        if (++emu.y > emu.ye) emu.y = emu.ys;
+    }
+}
+
+static void memory_byte(uint8_t data)
+{
+    int format = emu.colmod & 0x07;
+    int need = format == 5 ? 2 : 3;
+
+    emu.pending[emu.pending_count++] = data;
+    if (emu.pending_count < need) return;
+    emu.pending_count = 0;
+
+    const uint8_t *d = emu.pending;
+    if (format == 5)
+    {
+        uint16_t c = (uint16_t)(d[0] << 8) | d[1];
+        uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        put_pixel((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+    }
+    else if (format == 3)
+    {
+        // 12 位：3 字节两个像素
+        put_pixel((d[0] >> 4) * 17, (d[0] & 0xF) * 17, (d[1] >> 4) * 17);
+        put_pixel((d[1] & 0xF) * 17, (d[2] >> 4) * 17, (d[2] & 0xF) * 17);
+    }
+    else
+    {
+        put_pixel(d[0] | (d[0] >> 6), d[1] | (d[1] >> 6), d[2] | (d[2] >> 6));
+    }
+}
+
+static void command(uint8_t cmd)
+{
+    emu.cmd = cmd;
+    emu.param_count = 0;
+    emu.pending_count = 0;
+    emu.stats.commands++;
+
+    switch (cmd)
+    {
+        case CMD_SWRESET:
+            emu.madctl = 0;
+            emu.colmod = 0x66;
+            break;
+        case CMD_CASET:
+        case CMD_RASET:
+            emu.stats.address_sets++;
+            break;
+        case CMD_RAMWR:
+            emu.x = emu.xs;
+            emu.y = emu.ys;
+            emu.stats.memory_writes++;
+            break;
+        case CMD_RAMWRC:
+            emu.stats.memory_writes++;
+            break;
+        default:
+            break;
+    }
+}
+
+static void parameter(uint8_t data)
+{
+    if (emu.cmd == CMD_RAMWR || emu.cmd == CMD_RAMWRC)
+    {
+        memory_byte(data);
+        return;
+    }
+    if (emu.param_count < sizeof(emu.params)) emu.params[emu.param_count] = data;
+    emu.param_count++;
+
+    if (emu.cmd == CMD_CASET && emu.param_count == 4)
+    {
+        emu.xs = (uint16_t)(emu.params[0] << 8) | emu.params[1];
+        emu.xe = (uint16_t)(emu.params[2] << 8) | emu.params[3];
+    }
+    else if (emu.cmd == CMD_RASET && emu.param_count == 4)
+    {
+        emu.ys = (uint16_t)(emu.params[0] << 8) | emu.params[1];
+        emu.ye = (uint16_t)(emu.params[2] << 8) | emu.params[3];
+    }
+    else if (emu.cmd == CMD_MADCTL && emu.param_count == 1)
+    {
+        emu.madctl = data;
+    }
+    else if (emu.cmd == CMD_COLMOD && emu.param_count == 1)
+    {
+        emu.colmod = data;
+    }
+}
+
+void st7789_emulator_init(void)
+{
+    memset(&emu, 0, sizeof(emu));
+    emu.colmod = 0x66;
+    emu.xe = ST7789_EMULATOR_GRAM_COLUMNS - 1;
+    emu.ye = ST7789_EMULATOR_GRAM_ROWS - 1;
+    emu.overhead_ns = ST7789_EMULATOR_DEFAULT_OVERHEAD_NS;
+}
+
+void st7789_emulator_set_overhead_ns(uint32_t overhead_ns)
+{
+    emu.overhead_ns = overhead_ns;
+}
+
+void st7789_emulator_get_stats(st7789_emulator_stats_t *stats)
+{
+    *stats = emu.stats;
+}
+
+void st7789_emulator_reset_stats(void)
+{
+    memset(&emu.stats, 0, sizeof(emu.stats));
+}
+
+// 与 pico-sdk spi_set_baudrate 相同的分频搜索
+uint32_t st7789_emulator_spi_baudrate(uint32_t clk_peri_hz, uint32_t request_hz)
+{
+    uint32_t prescale, postdiv;
+
+    for (prescale = 2; prescale <= 254; prescale += 2)
+    {
+        if (clk_peri_hz < (prescale + 2) * 256 * (uint64_t)request_hz) break;
+    }
+    for (postdiv = 256; postdiv > 1; --postdiv)
+    {
+        if (clk_peri_hz / (prescale * (postdiv - 1)) > request_hz) break;
+    }
+    return clk_peri_hz / (prescale * postdiv);
+}
+
+uint64_t st7789_emulator_wire_ns(const st7789_emulator_stats_t *stats, uint32_t spi_hz)
+{
+    uint64_t bits = (stats->cmd_bytes + stats->data_bytes) * 8;
+    return bits * 1000000000ull / spi_hz + (uint64_t)stats->transactions * emu.overhead_ns;
+}
+
+int st7789_emulator_read_window(uint16_t left, uint16_t top, uint16_t width, uint16_t height, uint16_t *rgb565)
+{
+    for (uint16_t y = 0; y < height; y++)
+    {
+        for (uint16_t x = 0; x < width; x++)
+        {
+            uint32_t *p = gram_at(left + x, top + y);
+            if (p == NULL) return -1;
+            uint32_t c = *p;
+            *rgb565++ = (uint16_t)(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+        }
+    }
+    return 0;
+}
+
+static uint32_t crc_table[256];
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    if (crc_table[1] == 0)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            crc_table[n] = c;
+        }
+    }
+    for (size_t i = 0; i < len; i++) crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void png_chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len)
+{
+    uint8_t head[8];
+    uint32_t crc;
+
+    put_be32(head, len);
+    memcpy(head + 4, type, 4);
+    crc = crc32_update(0xFFFFFFFF, head + 4, 4);
+    crc = crc32_update(crc, data, len);
+    fwrite(head, 1, 8, f);
+    fwrite(data, 1, len, f);
+    put_be32(head, crc ^ 0xFFFFFFFF);
+    fwrite(head, 1, 4, f);
+}
+
+// 不压缩的 PNG：zlib 存储块，不依赖外部库
+int st7789_emulator_dump_png(const char *path, uint16_t left, uint16_t top, uint16_t width, uint16_t height)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    uint32_t row_bytes = 1 + width * 3;
+    uint32_t raw_len = row_bytes * height;
+    uint32_t blocks = (raw_len + 65534) / 65535;
+    uint32_t idat_len = 2 + raw_len + blocks * 5 + 4;
+    uint8_t ihdr[13];
+    static uint8_t idat[2 + ST7789_EMULATOR_GRAM_ROWS * (1 + ST7789_EMULATOR_GRAM_ROWS * 3) + 32 * 5 + 4];
+    static uint8_t raw[ST7789_EMULATOR_GRAM_ROWS * (1 + ST7789_EMULATOR_GRAM_ROWS * 3)];
+    uint32_t a = 1, b = 0, pos = 0;
+    FILE *f;
+
+    if (raw_len > sizeof(raw)) return -1;
+    for (uint16_t y = 0; y < height; y++)
+    {
+        uint8_t *row = raw + y * row_bytes;
+        row[0] = 0;
+        for (uint16_t x = 0; x < width; x++)
+        {
+            uint32_t *p = gram_at(left + x, top + y);
+            uint32_t c = p != NULL ? *p : 0;
+            row[1 + x * 3] = c >> 16;
+            row[2 + x * 3] = c >> 8;
+            row[3 + x * 3] = c;
+        }
+    }
+
+    idat[pos++] = 0x78;
+    idat[pos++] = 0x01;
+    for (uint32_t off = 0; off < raw_len; off += 65535)
+    {
+        uint32_t n = raw_len - off < 65535 ? raw_len - off : 65535;
+        idat[pos++] = off + n == raw_len;
+        idat[pos++] = n & 0xFF;
+        idat[pos++] = n >> 8;
+        idat[pos++] = ~n & 0xFF;
+        idat[pos++] = (~n >> 8) & 0xFF;
+        memcpy(idat + pos, raw + off, n);
+        pos += n;
+    }
+    for (uint32_t i = 0; i < raw_len; i++)
+    {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(idat + pos, (b << 16) | a);
+    pos += 4;
+
+    put_be32(ihdr, width);
+    put_be32(ihdr + 4, height);
+    ihdr[8] = 8;
+    ihdr[9] = 2;
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    f = fopen(path, "wb");
+    if (f == NULL) return -1;
+    fwrite(signature, 1, sizeof(signature), f);
+    png_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    png_chunk(f, "IDAT", idat, idat_len);
+    png_chunk(f, "IEND", NULL, 0);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+uint8_t st7789_interface_spi_init(void)
+{
+    return 0;
+}
+
+uint8_t st7789_interface_spi_deinit(void)
+{
+    return 0;
+}
+
+// 每次调用即一次 CS 拉低到拉高的传输，DC 在调用前已由 cmd_data_gpio_write 设定
+uint8_t st7789_interface_spi_write_cmd(uint8_t *buf, uint16_t len)
+{
+    emu.stats.transactions++;
+    emu.stats.cs_toggles += 2;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        if (emu.dc) parameter(buf[i]);
+        else command(buf[i]);
+    }
+    if (emu.dc) emu.stats.data_bytes += len;
+    else emu.stats.cmd_bytes += len;
+    return 0;
+}
+
+void st7789_interface_delay_ms(uint32_t ms)
+{
+    emu.stats.delay_ms += ms;
+}
+
+void st7789_interface_debug_print(const char *const fmt, ...)
+{
+    (void)fmt;
+}
+
+uint8_t st7789_interface_cmd_data_gpio_init(void)
+{
+    return 0;
+}
+
+uint8_t st7789_interface_cmd_data_gpio_deinit(void)
+{
+    return 0;
+}
+
+uint8_t st7789_interface_cmd_data_gpio_write(uint8_t value)
+{
+    value = value ? 1 : 0;
+    if (value != emu.dc) emu.stats.dc_flips++;
+    emu.dc = value;
+    return 0;
+}
+
+uint8_t st7789_interface_reset_gpio_init(void)
+{
+    return 0;
+}
+
+uint8_t st7789_interface_reset_gpio_deinit(void)
+{
+    return 0;
+}
+
+uint8_t st7789_interface_reset_gpio_write(uint8_t value)
+{
+    (void)value;
+    return 0;
+}
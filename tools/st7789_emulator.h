@@ -0,0 +1,44 @@
+#ifndef _ST7789_EMULATOR_H_
+#define _ST7789_EMULATOR_H_
+
+#include <stdint.h>
+
+// 主机端 ST7789 命令流模型，实现 driver_st7789_interface.h 的全部接口
+// 解码 CASET/RASET/RAMWR/RAMWRC/MADCTL/COLMOD 写入 240x320 GRAM，并统计 SPI 开销
+#define ST7789_EMULATOR_GRAM_COLUMNS 240
+#define ST7789_EMULATOR_GRAM_ROWS 320
+// 与 st7789_interface_spi_init 请求的频率一致
+#define ST7789_EMULATOR_SPI_HZ 60000000
+#define ST7789_EMULATOR_CLK_PERI_HZ 125000000
+// 每次传输 CS 翻转和 spi_write_blocking 等待 FIFO 排空的软件开销
+#define ST7789_EMULATOR_DEFAULT_OVERHEAD_NS 500
+
+typedef struct
+{
+    uint32_t transactions;
+    uint32_t cs_toggles;
+    uint32_t dc_flips;
+    uint32_t commands;
+    uint32_t address_sets;      // CASET/RASET 次数
+    uint32_t memory_writes;     // RAMWR/RAMWRC 次数
+    uint64_t cmd_bytes;
+    uint64_t data_bytes;
+    uint64_t pixels;
+    uint32_t delay_ms;
+} st7789_emulator_stats_t;
+
+void st7789_emulator_init(void);
+void st7789_emulator_set_overhead_ns(uint32_t overhead_ns);
+void st7789_emulator_get_stats(st7789_emulator_stats_t *stats);
+void st7789_emulator_reset_stats(void);
+
+// SDK spi_set_baudrate 在给定外设时钟下实际得到的 SPI 频率
+uint32_t st7789_emulator_spi_baudrate(uint32_t clk_peri_hz, uint32_t request_hz);
+// 按给定 SPI 频率估算线上时间，含每次传输的固定开销
+uint64_t st7789_emulator_wire_ns(const st7789_emulator_stats_t *stats, uint32_t spi_hz);
+
+// 按当前 MADCTL 把逻辑窗口 (left, top, width, height) 读回为 RGB565 并写成 PNG
+int st7789_emulator_read_window(uint16_t left, uint16_t top, uint16_t width, uint16_t height, uint16_t *rgb565);
+int st7789_emulator_dump_png(const char *path, uint16_t left, uint16_t top, uint16_t width, uint16_t height);
+
+#endif
@@ -0,0 +1,203 @@
+// 主机端 USB CDC 帧流接收工具（Linux/macOS）
+//
+// 编译：
+//   cc -O2 -I. -o stream_receive tools/stream_receive.c
+// 用法：
+//   stream_receive /dev/ttyACM0 [out.bin]
+// 校验 CRC，按序号统计丢帧，每秒打印一次统计和最新的 ROI 统计；
+// 指定输出文件时逐包写入 stream_header_t + 载荷
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+#include "include/stream_format.h"
+
+// 序号回退超过这么多帧，或回到 0/1，才认为设备重启；更小的回退是重复或重放的旧包
+#define RESTART_BACKWARD_FRAMES 64
+
+typedef struct
+{
+    uint32_t packets;
+    uint32_t frames;
+    uint32_t dropped;
+    uint32_t crc_errors;
+    uint32_t resyncs;
+    uint32_t restarts;      // 序号大幅回退（设备重启）的次数
+    uint32_t duplicates;    // 序号相同或小幅回退的包，不计入帧数
+    uint32_t last_sequence;
+    int have_sequence;
+    stream_roi_t roi[STREAM_ROI_NUM];
+    int have_roi;
+} receive_stats_t;
+
+static int open_port(const char *path)
+{
+    struct termios tio;
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+
+    if (fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+static int payload_length(uint8_t type)
+{
+    if (type == STREAM_TYPE_TEMPERATURE) return STREAM_PIXEL_NUM * 2;
+    if (type == STREAM_TYPE_RAW) return STREAM_FRAME_WORDS * 2;
+    if (type == STREAM_TYPE_ROI) return STREAM_ROI_NUM * sizeof(stream_roi_t);
+    return -1;
+}
+
+// 尝试在 buf 开头解析一个包，返回消耗的字节数，数据不足返回 0
+static int parse_packet(const uint8_t *buf, int size, receive_stats_t *stats, FILE *out)
+{
+    stream_header_t header;
+    uint32_t sync = STREAM_SYNC;
+
+    if (size < (int)sizeof(sync)) return 0;
+    if (memcmp(buf, &sync, sizeof(sync)) != 0)
+    {
+        stats->resyncs++;
+        return 1;
+    }
+    if (size < (int)sizeof(header)) return 0;
+    memcpy(&header, buf, sizeof(header));
+    if (header.version != STREAM_VERSION || header.length != payload_length(header.type))
+    {
+        stats->resyncs++;
+        return 1;
+    }
+
+    int total = sizeof(header) + header.length + 2;
+    if (size < total) return 0;
+    uint16_t crc = buf[total - 2] | (buf[total - 1] << 8);
+    if (stream_crc16(0xFFFF, buf, total - 2) != crc)
+    {
+        stats->crc_errors++;
+        return 1;
+    }
+
+    // ROI 包沿用所属帧的序号，不参与丢帧统计
+    if (header.type == STREAM_TYPE_ROI)
+    {
+        memcpy(stats->roi, buf + sizeof(header), sizeof(stats->roi));
+        stats->have_roi = 1;
+    }
+    else
+    {
+        // 序号相同或小幅回退是重复/重放的旧包；大幅回退或回到 0/1 说明设备重启后从头计数
+        int duplicate = 0;
+        if (stats->have_sequence && header.sequence == stats->last_sequence)
+        {
+            duplicate = 1;
+        }
+        else if (stats->have_sequence && header.sequence < stats->last_sequence)
+        {
+            if (header.sequence <= 1 || stats->last_sequence - header.sequence > RESTART_BACKWARD_FRAMES)
+            {
+                stats->restarts++;
+            }
+            else
+            {
+                duplicate = 1;
+            }
+        }
+        else if (stats->have_sequence && header.sequence != stats->last_sequence + 1)
+        {
+            stats->dropped += header.sequence - stats->last_sequence - 1;
+        }
+
+        if (duplicate)
+        {
+            // 不计帧，也不移动序号
+            stats->duplicates++;
+        }
+        else
+        {
+            stats->last_sequence = header.sequence;
+            stats->have_sequence = 1;
+            stats->frames++;
+        }
+    }
+    stats->packets++;
+    if (out != NULL) fwrite(buf, 1, total - 2, out);
+    return total;
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[STREAM_PACKET_MAX * 4];
+    receive_stats_t stats = {0};
+    uint32_t reported_frames = 0;
+    time_t last_report = time(NULL);
+    int fill = 0;
+    FILE *out = NULL;
+    int fd;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <serial device> [output file]\n", argv[0]);
+        return 1;
+    }
+    fd = open_port(argv[1]);
+    if (fd < 0) return 1;
+    if (argc >= 3)
+    {
+        out = fopen(argv[2], "wb");
+        if (out == NULL)
+        {
+            perror(argv[2]);
+            return 1;
+        }
+    }
+
+    while (1)
+    {
+        ssize_t n = read(fd, buf + fill, sizeof(buf) - fill);
+        if (n <= 0) break;
+        fill += n;
+
+        int offset = 0;
+        int used;
+        while ((used = parse_packet(buf + offset, fill - offset, &stats, out)) > 0) offset += used;
+        memmove(buf, buf + offset, fill - offset);
+        fill -= offset;
+
+        time_t now = time(NULL);
+        if (now != last_report)
+        {
+            printf("%u fps, packets %u dropped %u crc errors %u resync bytes %u restarts %u duplicates %u\n",
+                   (unsigned)((stats.frames - reported_frames) / (now - last_report)), stats.packets,
+                   stats.dropped, stats.crc_errors, stats.resyncs, stats.restarts, stats.duplicates);
+            for (int i = 0; stats.have_roi && i < STREAM_ROI_NUM; i++)
+            {
+                const stream_roi_t *roi = &stats.roi[i];
+                if (roi->count == 0) continue;
+                printf("  roi %d pixels %u min %.2f @%u max %.2f @%u mean %.2f stddev %.2f\n", i, roi->count,
+                       roi->min / 100.0, roi->min_pixel, roi->max / 100.0, roi->max_pixel,
+                       roi->mean / 100.0, roi->stddev / 100.0);
+            }
+            fflush(stdout);
+            reported_frames = stats.frames;
+            last_report = now;
+        }
+    }
+    printf("total packets %u dropped %u crc errors %u resync bytes %u restarts %u duplicates %u\n",
+           stats.packets, stats.dropped, stats.crc_errors, stats.resyncs, stats.restarts, stats.duplicates);
+    if (out != NULL) fclose(out);
+    close(fd);
+    return 0;
+}